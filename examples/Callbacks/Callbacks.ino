@@ -0,0 +1,46 @@
+#include <Radar_MR24HPC1.h>  // Radar sensor
+
+// Init RADAR
+Radar_MR24HPC1 radar = Radar_MR24HPC1(&Serial1);
+
+void presence_changed(Radar_MR24HPC1 *radar, int presence) {
+  if (presence == OCCUPIED) {
+    Serial.println("Occupied");
+  } else {
+    Serial.println("Unoccupied");
+  }
+}
+
+void motion_changed(Radar_MR24HPC1 *radar, int motion) {
+  Serial.print("Motion: ");
+  Serial.println(motion);
+}
+
+void sensor_report(Radar_MR24HPC1 *radar, const Radar_SensorReport &report) {
+  Serial.print("Motion energy: ");
+  Serial.print(report.motion_energy);
+  Serial.print(" distance: ");
+  Serial.print(report.motion_distance);
+  Serial.println(" cm");
+}
+
+void setup() {
+  Serial.begin(115200);   // Serial print
+  Serial1.begin(115200);  // Radar
+
+  while (!Serial1) {
+    Serial.println("Radar disconnected");
+    delay(100);
+  }
+  Serial.println("Radar ready");
+
+  radar.on_presence(presence_changed);
+  radar.on_motion(motion_changed);
+  radar.on_sensor_report(sensor_report);
+
+  radar.set_mode(ADVANCED);
+}
+
+void loop() {
+  radar.run(NONVERBAL);  // Callbacks are called from here
+}
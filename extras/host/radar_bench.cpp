@@ -0,0 +1,383 @@
+/*
+Copyright 2023 Tauno Erik
+
+Parser and dispatch benchmark
+
+Feeds byte streams through feed()/read() and run() and reports
+frames/s, ns/frame, MB/s and worst single call time per command.
+
+Build:
+  g++ -std=c++11 -O2 -Isrc src/Radar_MR24HPC1.cpp src/host/Radar_host.cpp \
+    src/host/Radar_simulator.cpp extras/host/radar_bench.cpp -o radar_bench
+
+Run:
+  ./radar_bench [capture.bin ...]
+capture.bin - raw bytes recorded from radar UART, for example:
+  cat /dev/ttyUSB0 > capture.bin
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <vector>
+
+#include "Radar_MR24HPC1.h"
+#include "host/Radar_simulator.h"
+
+#ifndef BENCH_FRAMES
+#define BENCH_FRAMES 20000  // Frames in one synthetic stream
+#endif
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS 10     // Best of rounds is reported
+#endif
+#define BENCH_CHUNK  64     // Bytes per feed(), like one UART read
+
+typedef std::vector<uint8_t> Bytes;
+
+static uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+Frames the library has a handler for, with typical data
+*/
+struct BenchFrame {
+  uint8_t control_word;
+  uint8_t cmd_word;
+  uint8_t len;
+  uint8_t data[8];
+};
+
+static const BenchFrame all_frames[] = {
+  {0x01, 0x01, 1, {0x0F}},
+  {0x01, 0x02, 1, {0x0F}},
+  {0x02, 0xA1, 8, {'M', 'R', '2', '4', 'H', 'P', 'C', '1'}},
+  {0x02, 0xA2, 8, {'0', '0', '0', '0', '0', '0', '0', '1'}},
+  {0x02, 0xA3, 8, {'G', '6', '0', 'S', 'M', '1', 'S', 'Y'}},
+  {0x02, 0xA4, 8, {'v', '0', '1', '0', '1', '0', '6', 0}},
+  {0x03, 0x01, 1, {0x00}},
+  {0x05, 0x01, 1, {0x0F}},
+  {0x05, 0x07, 1, {RANGE_300_CM}},
+  {0x05, 0x08, 1, {RANGE_250_CM}},
+  {0x05, 0x09, 1, {0x01}},
+  {0x05, 0x0A, 1, {0x0F}},
+  {0x05, 0x81, 1, {0x01}},
+  {0x05, 0x85, 1, {0x03}},
+  {0x05, 0x87, 1, {0x01}},
+  {0x05, 0x88, 1, {0x03}},
+  {0x05, 0x89, 1, {0x01}},
+  {0x08, 0x00, 1, {0x01}},
+  {0x08, 0x01, 5, {60, 0x03, 120, 0x04, 0x03}},
+  {0x08, 0x08, 1, {30}},
+  {0x08, 0x09, 1, {30}},
+  {0x08, 0x0A, 1, {RANGE_250_CM}},
+  {0x08, 0x0B, 1, {RANGE_300_CM}},
+  {0x08, 0x0C, 4, {0x00, 0x00, 0x00, 0x96}},
+  {0x08, 0x0D, 4, {0x00, 0x00, 0x0B, 0xB8}},
+  {0x08, 0x0E, 4, {0x00, 0x00, 0x75, 0x30}},
+  {0x08, 0x80, 1, {0x01}},
+  {0x08, 0x81, 1, {60}},
+  {0x08, 0x82, 1, {120}},
+  {0x08, 0x83, 1, {0x03}},
+  {0x08, 0x84, 1, {0x04}},
+  {0x08, 0x88, 1, {30}},
+  {0x08, 0x89, 1, {30}},
+  {0x08, 0x8A, 1, {RANGE_250_CM}},
+  {0x08, 0x8B, 1, {RANGE_300_CM}},
+  {0x08, 0x8C, 4, {0x00, 0x00, 0x00, 0x96}},
+  {0x08, 0x8D, 4, {0x00, 0x00, 0x0B, 0xB8}},
+  {0x08, 0x8E, 4, {0x00, 0x00, 0x75, 0x30}},
+  {0x80, 0x01, 1, {OCCUPIED}},
+  {0x80, 0x02, 1, {ACTIVE}},
+  {0x80, 0x03, 1, {30}},
+  {0x80, 0x0A, 1, {TIME_30_S}},
+  {0x80, 0x0B, 1, {APPROACHING}},
+  {0x80, 0x81, 1, {OCCUPIED}},
+  {0x80, 0x82, 1, {ACTIVE}},
+  {0x80, 0x83, 1, {30}},
+  {0x80, 0x8A, 1, {TIME_30_S}},
+  {0x80, 0x8B, 1, {APPROACHING}},
+  {0x09, 0x01, 1, {0x00}},  // No handler
+};
+
+// Normal traffic: reports only
+static const BenchFrame report_frames[] = {
+  {0x08, 0x01, 5, {60, 0x03, 120, 0x04, 0x03}},
+  {0x80, 0x01, 1, {OCCUPIED}},
+  {0x80, 0x02, 1, {ACTIVE}},
+  {0x80, 0x03, 1, {30}},
+};
+
+// Header and tail bytes inside data
+static const BenchFrame escape_frames[] = {
+  {0x08, 0x01, 5, {HEAD1, HEAD2, END1, END2, HEAD1}},
+  {0x02, 0xA1, 8, {HEAD1, HEAD2, 0x00, 0x10, END1, END2, HEAD1, END2}},
+  {0x08, 0x8C, 4, {HEAD1, HEAD2, END1, END2}},
+  {0x80, 0x03, 1, {END2}},
+  {0x80, 0x01, 1, {HEAD1}},
+};
+
+/*
+Frames from table to byte stream, made by simulator
+*/
+static Bytes make_stream(const BenchFrame *table, size_t count,
+                         float corrupt, bool garbage) {
+  Radar_MemoryStream out, in;
+  out.connect(&in);
+  Radar_Simulator sim(&out);
+  Radar_SimConfig config;
+  config.corrupt = corrupt;
+  sim.set_config(config);
+
+  uint32_t random = 12345;
+
+  for (int i = 0; i < BENCH_FRAMES; i++) {
+    const BenchFrame &f = table[i % count];
+    sim.send_frame(f.control_word, f.cmd_word, f.data, f.len);
+
+    if (garbage) {
+      // Noise and false frame starts between frames
+      random ^= random << 13;
+      random ^= random >> 17;
+      random ^= random << 5;
+      uint8_t junk[6] = {static_cast<uint8_t>(random), HEAD1, HEAD2,
+                         static_cast<uint8_t>(random >> 8), 0xFF, HEAD1};
+      out.write(junk, 1 + (random >> 24) % sizeof(junk));
+    }
+  }
+
+  Bytes bytes(in.available());
+  in.read_bytes(bytes.data(), bytes.size());
+  return bytes;
+}
+
+static bool load_file(const char *path, Bytes *bytes) {
+  FILE *file = fopen(path, "rb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  uint8_t buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    bytes->insert(bytes->end(), buffer, buffer + n);
+  }
+
+  fclose(file);
+  return true;
+}
+
+/*
+Start and size of every complete frame, by length bytes
+Checksum is not checked, broken frames cost time too.
+*/
+struct Span {
+  size_t start;
+  size_t size;
+};
+
+static std::vector<Span> find_frames(const Bytes &bytes) {
+  std::vector<Span> spans;
+  size_t i = 0;
+
+  while (i + FRAME_OVERHEAD <= bytes.size()) {
+    if (bytes[i] != HEAD1 || bytes[i + 1] != HEAD2) {
+      i++;
+      continue;
+    }
+
+    size_t size = ((bytes[i + I_LENGHT_H] << 8) | bytes[i + I_LENGHT_L])
+                  + FRAME_OVERHEAD;
+    if (size > FRAME_SIZE || i + size > bytes.size()
+        || bytes[i + size - 2] != END1 || bytes[i + size - 1] != END2) {
+      i++;
+      continue;
+    }
+
+    spans.push_back(Span{i, size});
+    i += size;
+  }
+
+  return spans;
+}
+
+/*
+Whole stream in BENCH_CHUNK pieces with feed() and run()
+Returns best time of BENCH_ROUNDS in ns
+*/
+static uint64_t bench_feed(const Bytes &bytes, uint32_t *unknown) {
+  uint64_t best = ~0ULL;
+
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    Radar_MemoryStream idle;
+    Radar_Counters counters;  // Unknown frames
+    Radar_MR24HPC1 radar(&idle);
+    radar.set_counters(&counters);
+
+    uint64_t start = now_ns();
+
+    size_t pos = 0;
+    while (pos < bytes.size()) {
+      size_t len = bytes.size() - pos;
+      if (len > BENCH_CHUNK) {
+        len = BENCH_CHUNK;
+      }
+      pos += radar.feed(bytes.data() + pos, len);
+      radar.run();
+    }
+
+    uint64_t time = now_ns() - start;
+    if (time < best) {
+      best = time;
+    }
+    *unknown = radar.get_unknown_frames();
+  }
+
+  return best;
+}
+
+/*
+Whole stream through Stream and read(), as from serial port
+*/
+static uint64_t bench_stream(const Bytes &bytes) {
+  uint64_t best = ~0ULL;
+
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    Radar_MemoryStream radar_side, device_side;
+    radar_side.connect(&device_side);
+    device_side.write(bytes.data(), bytes.size());
+    Radar_MR24HPC1 radar(&radar_side);
+
+    uint64_t start = now_ns();
+
+    while (radar_side.available() > 0) {
+      radar.run();
+    }
+
+    uint64_t time = now_ns() - start;
+    if (time < best) {
+      best = time;
+    }
+  }
+
+  return best;
+}
+
+static void print_result(const char *name, const Bytes &bytes,
+                         size_t frames, uint64_t time, uint32_t unknown) {
+  double seconds = time / 1e9;
+
+  printf("%-18s %8zu %9zu %12.0f %9.1f %8.2f %8u\n",
+         name, frames, bytes.size(),
+         frames / seconds, static_cast<double>(time) / frames,
+         bytes.size() / seconds / 1e6, unknown);
+}
+
+/*
+Time of feed() and run() for every frame alone,
+per control and command word
+*/
+static uint64_t command_total[256][256];
+static uint64_t command_worst[256][256];
+static uint32_t command_count[256][256];
+
+static void bench_commands(const Bytes &bytes) {
+  std::vector<Span> spans = find_frames(bytes);
+
+  Radar_MemoryStream idle;
+  Radar_MR24HPC1 radar(&idle);
+
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    for (size_t i = 0; i < spans.size(); i++) {
+      const uint8_t *frame = bytes.data() + spans[i].start;
+      uint8_t c = frame[I_CONTROL_WORD];
+      uint8_t d = frame[I_CMD_WORD];
+
+      uint64_t start = now_ns();
+      radar.feed(frame, spans[i].size);
+      radar.run();
+      uint64_t time = now_ns() - start;
+
+      command_total[c][d] += time;
+      command_count[c][d]++;
+      if (time > command_worst[c][d]) {
+        command_worst[c][d] = time;
+      }
+    }
+  }
+}
+
+static void print_commands() {
+  printf("\n%-10s %9s %8s %8s\n", "command", "calls", "avg ns", "max ns");
+
+  for (int c = 0; c < 256; c++) {
+    for (int d = 0; d < 256; d++) {
+      if (command_count[c][d] > 0) {
+        printf("0x%02X 0x%02X  %9u %8.0f %8llu\n", c, d, command_count[c][d],
+               static_cast<double>(command_total[c][d]) / command_count[c][d],
+               static_cast<unsigned long long>(command_worst[c][d]));
+      }
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  radar_set_log_sink(nullptr);  // Handlers print, don't measure terminal
+
+  printf("%-18s %8s %9s %12s %9s %8s %8s\n",
+         "stream", "frames", "bytes", "frames/s", "ns/frame", "MB/s",
+         "unknown");
+
+  struct Scenario {
+    const char *name;
+    Bytes bytes;
+  };
+  std::vector<Scenario> scenarios;
+
+  scenarios.push_back(Scenario{"reports",
+    make_stream(report_frames, 4, 0, false)});
+  scenarios.push_back(Scenario{"all commands",
+    make_stream(all_frames, sizeof(all_frames) / sizeof(all_frames[0]),
+                0, false)});
+  scenarios.push_back(Scenario{"header bytes",
+    make_stream(escape_frames, 5, 0, false)});
+  scenarios.push_back(Scenario{"bad checksum 50%",
+    make_stream(report_frames, 4, 0.5, false)});
+  scenarios.push_back(Scenario{"garbage",
+    make_stream(report_frames, 4, 0, true)});
+
+  for (int i = 1; i < argc; i++) {
+    Bytes bytes;
+    if (!load_file(argv[i], &bytes)) {
+      perror(argv[i]);
+      return 1;
+    }
+    scenarios.push_back(Scenario{argv[i], bytes});
+  }
+
+  for (size_t i = 0; i < scenarios.size(); i++) {
+    const Bytes &bytes = scenarios[i].bytes;
+    size_t frames = find_frames(bytes).size();
+    if (frames == 0) {
+      printf("%-18s no frames\n", scenarios[i].name);
+      continue;
+    }
+
+    uint32_t unknown = 0;
+    uint64_t time = bench_feed(bytes, &unknown);
+    print_result(scenarios[i].name, bytes, frames, time, unknown);
+
+    bench_commands(bytes);
+  }
+
+  uint64_t time = bench_stream(scenarios[0].bytes);
+  print_result("reports read()", scenarios[0].bytes,
+               find_frames(scenarios[0].bytes).size(), time, 0);
+
+  print_commands();
+
+  return 0;
+}
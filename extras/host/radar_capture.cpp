@@ -0,0 +1,129 @@
+/*
+Copyright 2023 Tauno Erik
+
+Record radar frames or raw received bytes to capture file,
+or print a capture
+
+Build:
+  g++ -std=c++11 -O2 -Isrc src/Radar_MR24HPC1.cpp src/host/Radar_host.cpp \
+    extras/host/radar_capture.cpp -o radar_capture
+
+Run:
+  ./radar_capture record /dev/ttyUSB0 radar.rcap
+  ./radar_capture raw /dev/ttyUSB0 radar.rcap   # for exact replay
+  ./radar_capture dump radar.rcap
+*/
+
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Radar_MR24HPC1.h"
+
+static int record(const char *port_path, const char *file_path, bool raw) {
+  Radar_PosixStream port;
+  if (!port.open(port_path, 115200)) {
+    perror(port_path);
+    return 1;
+  }
+
+  Radar_FilePrint file;
+  if (!file.open(file_path, true)) {
+    perror(file_path);
+    return 1;
+  }
+
+  Radar_Recorder recorder;
+  recorder.begin(&file, file.size() > 0);  // Header only in new file
+  recorder.set_raw(raw);
+
+  Radar_MR24HPC1 radar(&port);
+  radar.set_recorder(&recorder);
+  radar.set_mode(ADVANCED);
+
+  unsigned long prev_millis = 0;
+
+  while (true) {
+    struct pollfd pfd = {port.get_fd(), POLLIN, 0};
+    poll(&pfd, 1, 100);
+
+    radar.run();
+
+    if (millis() - prev_millis >= 1000) {
+      prev_millis = millis();
+      radar.ask_presence();
+      file.flush();
+      printf("\r%u records", recorder.get_records());
+      fflush(stdout);
+    }
+  }
+
+  return 0;
+}
+
+static int dump(const char *file_path) {
+  FILE *file = fopen(file_path, "rb");
+  if (file == nullptr) {
+    perror(file_path);
+    return 1;
+  }
+
+  uint8_t header[CAPTURE_HEADER_SIZE];
+  if (fread(header, 1, sizeof(header), file) != sizeof(header)
+      || memcmp(header, "RCAP", 4) != 0) {
+    fprintf(stderr, "%s: not a capture file\n", file_path);
+    fclose(file);
+    return 1;
+  }
+
+  uint8_t record_header = header[5];
+  uint8_t buffer[256];
+  uint32_t first = 0;
+  uint32_t count = 0;
+
+  while (fread(buffer, 1, record_header, file) == record_header) {
+    uint8_t len = buffer[0];
+    uint8_t flags = buffer[1];
+    uint32_t time = buffer[2] | (buffer[3] << 8) | (buffer[4] << 16)
+                  | (static_cast<uint32_t>(buffer[5]) << 24);
+
+    uint8_t frame[256];
+    if (fread(frame, 1, len, file) != len) {
+      break;  // Last record was not fully written
+    }
+
+    if (count == 0) {
+      first = time;
+    }
+    count++;
+
+    printf("%10.6f %s%s", (time - first) / 1e6,
+           (flags & CAPTURE_TX) ? "TX" : "RX",
+           (flags & CAPTURE_BAD) ? " BAD"
+             : (flags & CAPTURE_RAW) ? " RAW" : "    ");
+    for (int i = 0; i < len; i++) {
+      printf(" %02X", frame[i]);
+    }
+    printf("\n");
+  }
+
+  fclose(file);
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  radar_set_log_sink(nullptr);
+
+  if (argc == 4 && strcmp(argv[1], "record") == 0) {
+    return record(argv[2], argv[3], false);
+  }
+  if (argc == 4 && strcmp(argv[1], "raw") == 0) {
+    return record(argv[2], argv[3], true);
+  }
+  if (argc == 3 && strcmp(argv[1], "dump") == 0) {
+    return dump(argv[2]);
+  }
+
+  printf("Usage: %s record|raw port file | dump file\n", argv[0]);
+  return 1;
+}
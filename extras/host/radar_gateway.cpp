@@ -0,0 +1,160 @@
+/*
+Copyright 2023 Tauno Erik
+
+Many radars on one thread with Radar_Manager
+
+Build:
+  g++ -std=c++11 -O2 -Isrc src/Radar_MR24HPC1.cpp src/host/Radar_host.cpp \
+    src/host/Radar_simulator.cpp src/host/Radar_manager.cpp \
+    extras/host/radar_gateway.cpp -o radar_gateway
+
+Run with real radars:
+  ./radar_gateway /dev/ttyUSB0 /dev/ttyUSB1 ...
+Run against simulators on pseudo-terminals, for load testing:
+  ./radar_gateway -s 200 [seconds] [report_ms]
+*/
+
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Radar_MR24HPC1.h"
+#include "host/Radar_manager.h"
+#include "host/Radar_simulator.h"
+
+static Radar_Manager manager;
+static uint32_t frames = 0;
+
+static void on_report(Radar_MR24HPC1 *radar,
+                      const Radar_SensorReport &report) {
+  frames++;
+}
+
+static void on_presence(Radar_MR24HPC1 *radar, int value) {
+  frames++;
+}
+
+/*
+Simulators for all slave paths, in child process
+*/
+static void run_simulators(char (*slaves)[64], int count, uint32_t report_ms) {
+  Radar_PosixStream *ports = new Radar_PosixStream[count];
+  Radar_Simulator **sims = new Radar_Simulator *[count];
+  struct pollfd *pfd = new struct pollfd[count];
+
+  Radar_SimConfig config;
+  config.sensor_report_ms = report_ms;
+  config.presence_report_ms = report_ms;
+  config.noise = 0.05;
+
+  for (int i = 0; i < count; i++) {
+    if (!ports[i].open(slaves[i])) {
+      perror(slaves[i]);
+      _exit(1);
+    }
+    sims[i] = new Radar_Simulator(&ports[i]);
+    config.seed = i + 1;
+    sims[i]->set_config(config);
+    pfd[i].fd = ports[i].get_fd();
+    pfd[i].events = POLLIN;
+  }
+
+  while (true) {
+    poll(pfd, count, 1);
+    unsigned long now = millis();
+    for (int i = 0; i < count; i++) {
+      sims[i]->run(now);
+    }
+  }
+}
+
+static double cpu_seconds() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+       + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  radar_set_log_sink(nullptr);
+
+  int seconds = 0;  // 0 forever
+  pid_t child = 0;
+
+  if (argc > 2 && strcmp(argv[1], "-s") == 0) {
+    int count = atoi(argv[2]);
+    seconds = argc > 3 ? atoi(argv[3]) : 10;
+    uint32_t report_ms = argc > 4 ? atoi(argv[4]) : 100;
+
+    char (*slaves)[64] = new char[count][64];
+    for (int i = 0; i < count; i++) {
+      Radar_PosixStream *port = new Radar_PosixStream();
+      if (!port->open_pty(slaves[i], sizeof(slaves[i]))) {
+        perror("pty");
+        return 1;
+      }
+      // Slave stays open here too, no hangup before simulator opens it
+      open(slaves[i], O_RDWR | O_NOCTTY | O_CLOEXEC);
+      manager.add(port);
+    }
+
+    child = fork();
+    if (child == 0) {
+      run_simulators(slaves, count, report_ms);
+    }
+  } else {
+    for (int i = 1; i < argc; i++) {
+      if (manager.add(argv[i]) < 0) {
+        perror(argv[i]);
+      }
+    }
+  }
+
+  if (manager.count() == 0) {
+    printf("Usage: %s port... | -s count [seconds] [report_ms]\n", argv[0]);
+    return 1;
+  }
+
+  for (int i = 0; i < manager.count(); i++) {
+    Radar_MR24HPC1 *radar = manager.get(i);
+    radar->on_sensor_report(on_report);
+    radar->on_presence(on_presence);
+    radar->set_mode(ADVANCED);
+  }
+  manager.poll_every(&Radar_MR24HPC1::ask_presence, 1000);
+  manager.poll_every(&Radar_MR24HPC1::ask_heartbeat, 5000);
+
+  unsigned long start = millis();
+  unsigned long prev_millis = start;
+  double prev_cpu = cpu_seconds();
+  uint32_t prev_frames = 0;
+
+  while (seconds == 0 || millis() - start < seconds * 1000UL) {
+    manager.run(100);
+
+    if (millis() - prev_millis >= 1000) {
+      double cpu = cpu_seconds();
+      double wall = (millis() - prev_millis) / 1000.0;
+      printf("radars %d frames/s %.0f queries %u cpu %.1f%%\n",
+             manager.count(), (frames - prev_frames) / wall,
+             manager.get_queries_sent(), 100 * (cpu - prev_cpu) / wall);
+      prev_millis = millis();
+      prev_cpu = cpu;
+      prev_frames = frames;
+    }
+  }
+
+  if (child > 0) {
+    kill(child, SIGTERM);
+    waitpid(child, nullptr, 0);
+  }
+
+  return 0;
+}
@@ -0,0 +1,58 @@
+/*
+Copyright 2023 Tauno Erik
+
+Radar_MR24HPC1 on Linux
+
+Build:
+  g++ -std=c++11 -O2 -Isrc src/Radar_MR24HPC1.cpp src/host/Radar_host.cpp \
+    extras/host/radar_host.cpp -o radar_host
+
+Run with real radar:
+  ./radar_host /dev/ttyUSB0
+Run without radar, creates pseudo-terminal for simulator:
+  ./radar_host
+*/
+
+#include <poll.h>
+#include <stdio.h>
+
+#include "Radar_MR24HPC1.h"
+
+int main(int argc, char *argv[]) {
+  Radar_PosixStream port;
+
+  setvbuf(stdout, nullptr, _IOLBF, 0);  // Log line by line
+
+  if (argc > 1) {
+    if (!port.open(argv[1], 115200)) {
+      perror(argv[1]);
+      return 1;
+    }
+  } else {
+    char slave[64];
+    if (!port.open_pty(slave, sizeof(slave))) {
+      perror("pty");
+      return 1;
+    }
+    printf("Radar pty: %s\n", slave);
+  }
+
+  Radar_MR24HPC1 radar(&port);
+  radar.set_mode(ADVANCED);
+
+  unsigned long prev_millis = 0;
+
+  while (true) {
+    struct pollfd pfd = {port.get_fd(), POLLIN, 0};
+    poll(&pfd, 1, 100);
+
+    radar.run(VERBAL);
+
+    if (millis() - prev_millis >= 1000) {
+      prev_millis = millis();
+      radar.ask_presence();
+    }
+  }
+
+  return 0;
+}
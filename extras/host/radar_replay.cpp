@@ -0,0 +1,199 @@
+/*
+Copyright 2023 Tauno Erik
+
+Replay capture file through the parser and handlers
+
+Build:
+  g++ -std=c++11 -O2 -Isrc src/Radar_MR24HPC1.cpp src/host/Radar_host.cpp \
+    src/host/Radar_simulator.cpp src/host/Radar_replay.cpp \
+    extras/host/radar_replay.cpp -o radar_replay
+
+Run:
+  ./radar_replay radar.rcap             # as fast as possible
+  ./radar_replay -r radar.rcap          # with recorded timing
+  ./radar_replay -n 100 radar.rcap      # 100 rounds, for benchmark
+  ./radar_replay -s state.txt radar.rcap   # save decoded state
+  ./radar_replay -c state.txt radar.rcap   # compare with saved state
+  ./radar_replay -m 1000000 test.rcap   # make capture with simulator
+
+State file has one line for every received frame or raw record.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Radar_MR24HPC1.h"
+#include "host/Radar_replay.h"
+#include "host/Radar_simulator.h"
+
+#define STATE_LINE 160
+
+struct Check {
+  FILE *file = nullptr;
+  bool save = false;
+  uint32_t index = 0;
+  uint32_t mismatches = 0;
+};
+
+static uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void format_state(const Radar_State &s, char *line, size_t size) {
+  snprintf(line, size, "%d %d %d %d %d %d %d %d %d %.2f %d\n",
+           s.heartbeat, s.presence, s.motion, s.activity, s.direction,
+           s.static_energy, s.static_distance,
+           s.motion_energy, s.motion_distance, s.motion_speed,
+           s.initialization_status);
+}
+
+/*
+Save or compare state after every record
+*/
+static void check_state(Radar_MR24HPC1 *radar,
+                        const Radar_ReplayRecord &record, void *user) {
+  Check *check = static_cast<Check *>(user);
+
+  Radar_State state;
+  radar->get_state(state);
+
+  char line[STATE_LINE];
+  format_state(state, line, sizeof(line));
+
+  if (check->save) {
+    fputs(line, check->file);
+  } else {
+    char expected[STATE_LINE];
+    if (fgets(expected, sizeof(expected), check->file) == nullptr) {
+      expected[0] = '\0';
+    }
+    if (strcmp(line, expected) != 0) {
+      if (check->mismatches < 10) {
+        printf("record %u at %.6f s\n  expected %s  decoded  %s",
+               check->index, record.time / 1e6, expected, line);
+      }
+      check->mismatches++;
+    }
+  }
+
+  check->index++;
+}
+
+/*
+Synthetic capture: simulator reports recorded by a radar
+Raw, so corrupted frames are replayed too.
+*/
+static int make(const char *path, uint32_t count) {
+  Radar_FilePrint file;
+  if (!file.open(path)) {
+    perror(path);
+    return 1;
+  }
+
+  Radar_MemoryStream sim_port;
+  Radar_MemoryStream radar_port;
+  sim_port.connect(&radar_port);
+
+  Radar_SimConfig config;
+  config.noise = 0.05f;
+  config.corrupt = 0.01f;
+  Radar_Simulator sim(&sim_port);
+  sim.set_config(config);
+
+  Radar_Recorder recorder;
+  recorder.begin(&file);
+  recorder.set_raw(true);
+
+  Radar_MR24HPC1 radar(&radar_port);
+  radar.set_recorder(&recorder);
+
+  unsigned long now = 0;
+  while (recorder.get_records() < count) {
+    sim.run(now);
+    radar.run();
+    now += 10;
+  }
+
+  recorder.end();
+  printf("%u records\n", recorder.get_records());
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  radar_set_log_sink(nullptr);
+
+  bool realtime = false;
+  int rounds = 1;
+  Check check;
+  const char *state_path = nullptr;
+  uint32_t make_count = 0;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "rn:s:c:m:")) != -1) {
+    switch (opt) {
+      case 'r': realtime = true; break;
+      case 'n': rounds = atoi(optarg); break;
+      case 's': state_path = optarg; check.save = true; break;
+      case 'c': state_path = optarg; check.save = false; break;
+      case 'm': make_count = strtoul(optarg, nullptr, 10); break;
+      default: optind = argc + 1; break;
+    }
+  }
+
+  if (optind != argc - 1 || rounds < 1) {
+    printf("Usage: %s [-r] [-n rounds] [-s|-c state.txt] [-m count] file\n",
+           argv[0]);
+    return 1;
+  }
+  const char *path = argv[optind];
+
+  if (make_count > 0) {
+    return make(path, make_count);
+  }
+
+  Radar_Replay replay;
+  if (!replay.open(path)) {
+    fprintf(stderr, "%s: not a capture file\n", path);
+    return 1;
+  }
+
+  if (state_path != nullptr) {
+    check.file = fopen(state_path, check.save ? "w" : "r");
+    if (check.file == nullptr) {
+      perror(state_path);
+      return 1;
+    }
+    rounds = 1;
+  }
+
+  Radar_MemoryStream port;  // Nothing to read, queries are dropped
+  uint32_t records = 0;
+  uint64_t start = now_ns();
+
+  for (int i = 0; i < rounds; i++) {
+    Radar_MR24HPC1 radar(&port);
+    replay.rewind();
+    records += replay.play(&radar, realtime, NONVERBAL,
+                          check.file != nullptr ? check_state : nullptr,
+                          &check);
+  }
+
+  double seconds = (now_ns() - start) / 1e9;
+  printf("%u records in %.3f s, %.0f records/s\n", records, seconds,
+         records / seconds);
+
+  if (check.file != nullptr) {
+    fclose(check.file);
+    if (!check.save) {
+      printf("%u mismatches\n", check.mismatches);
+      return check.mismatches > 0 ? 2 : 0;
+    }
+  }
+
+  return 0;
+}
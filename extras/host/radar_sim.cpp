@@ -0,0 +1,71 @@
+/*
+Copyright 2023 Tauno Erik
+
+MR24HPC1 simulator on pseudo-terminal
+
+Build:
+  g++ -std=c++11 -O2 -Isrc src/Radar_MR24HPC1.cpp src/host/Radar_host.cpp \
+    src/host/Radar_simulator.cpp extras/host/radar_sim.cpp -o radar_sim
+
+Run:
+  ./radar_sim [report_ms] [noise] [corrupt] [reply_delay_ms]
+  ./radar_host /dev/pts/N
+*/
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Radar_MR24HPC1.h"
+#include "host/Radar_simulator.h"
+
+int main(int argc, char *argv[]) {
+  Radar_PosixStream port;
+  char slave[64];
+
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+
+  if (!port.open_pty(slave, sizeof(slave))) {
+    perror("pty");
+    return 1;
+  }
+
+  Radar_SimConfig config;
+  if (argc > 1) {
+    config.sensor_report_ms = atoi(argv[1]);
+    config.presence_report_ms = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    config.noise = atof(argv[2]);
+  }
+  if (argc > 3) {
+    config.corrupt = atof(argv[3]);
+  }
+  if (argc > 4) {
+    config.reply_delay_ms = atoi(argv[4]);
+  }
+
+  Radar_Simulator sim(&port);
+  sim.set_config(config);
+
+  printf("Simulator pty: %s\n", slave);
+
+  unsigned long prev_millis = 0;
+
+  while (true) {
+    struct pollfd pfd = {port.get_fd(), POLLIN, 0};
+    poll(&pfd, 1, 1);
+
+    sim.run();
+
+    if (millis() - prev_millis >= 5000) {
+      prev_millis = millis();
+      const Radar_SimStats &stats = sim.get_stats();
+      printf("queries %u replies %u reports %u bad %u unknown %u\n",
+             stats.queries, stats.replies, stats.reports,
+             stats.bad_frames, stats.unknown);
+    }
+  }
+
+  return 0;
+}
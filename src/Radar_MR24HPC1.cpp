@@ -2,78 +2,488 @@
 Copyright 2023 Tauno Erik
 */
 
+#if defined(ARDUINO)
 #include "Arduino.h"
+#endif
 #include "Radar_MR24HPC1.h"
 
 Radar_MR24HPC1::Radar_MR24HPC1(Stream *s)
   : stream(s) {
-    this->is_new_frame = false;
 }
 
 /*
-  Receive radar frame and store it in frame array
-*/ 
+Fixed queries in flash, checksums are calculated at compile time
+*/
+static const Radar_Query QUERY_01_01 PROGMEM = radar_query(0x01, 0x01);
+static const Radar_Query QUERY_01_02 PROGMEM = radar_query(0x01, 0x02);
+static const Radar_Query QUERY_02_A1 PROGMEM = radar_query(0x02, 0xA1);
+static const Radar_Query QUERY_02_A2 PROGMEM = radar_query(0x02, 0xA2);
+static const Radar_Query QUERY_02_A3 PROGMEM = radar_query(0x02, 0xA3);
+static const Radar_Query QUERY_02_A4 PROGMEM = radar_query(0x02, 0xA4);
+static const Radar_Query QUERY_05_0A PROGMEM = radar_query(0x05, 0x0A);
+static const Radar_Query QUERY_05_81 PROGMEM = radar_query(0x05, 0x81);
+static const Radar_Query QUERY_05_85 PROGMEM = radar_query(0x05, 0x85);
+static const Radar_Query QUERY_05_87 PROGMEM = radar_query(0x05, 0x87);
+static const Radar_Query QUERY_05_88 PROGMEM = radar_query(0x05, 0x88);
+static const Radar_Query QUERY_05_89 PROGMEM = radar_query(0x05, 0x89);
+static const Radar_Query QUERY_08_00_OFF PROGMEM = radar_query(0x08, 0x00, 0x00);
+static const Radar_Query QUERY_08_00_ON PROGMEM = radar_query(0x08, 0x00, 0x01);
+static const Radar_Query QUERY_08_80 PROGMEM = radar_query(0x08, 0x80);
+static const Radar_Query QUERY_08_81 PROGMEM = radar_query(0x08, 0x81);
+static const Radar_Query QUERY_08_83 PROGMEM = radar_query(0x08, 0x83);
+static const Radar_Query QUERY_08_84 PROGMEM = radar_query(0x08, 0x84);
+static const Radar_Query QUERY_08_88 PROGMEM = radar_query(0x08, 0x88);
+static const Radar_Query QUERY_08_89 PROGMEM = radar_query(0x08, 0x89);
+static const Radar_Query QUERY_08_8A PROGMEM = radar_query(0x08, 0x8A);
+static const Radar_Query QUERY_08_8B PROGMEM = radar_query(0x08, 0x8B);
+static const Radar_Query QUERY_08_8C PROGMEM = radar_query(0x08, 0x8C);
+static const Radar_Query QUERY_08_8D PROGMEM = radar_query(0x08, 0x8D);
+static const Radar_Query QUERY_08_8E PROGMEM = radar_query(0x08, 0x8E);
+static const Radar_Query QUERY_80_81 PROGMEM = radar_query(0x80, 0x81);
+static const Radar_Query QUERY_80_82 PROGMEM = radar_query(0x80, 0x82);
+static const Radar_Query QUERY_80_83 PROGMEM = radar_query(0x80, 0x83);
+static const Radar_Query QUERY_80_8A PROGMEM = radar_query(0x80, 0x8A);
+static const Radar_Query QUERY_80_8B PROGMEM = radar_query(0x80, 0x8B);
+
+// Checksums known from radar manual
+static_assert(radar_query(0x08, 0x00, 0x01).bytes[QUERY_SIZE - 3] == 0xB6,
+              "Bad query checksum");
+static_assert(radar_query(0x08, 0x00, 0x00).bytes[QUERY_SIZE - 3] == 0xB5,
+              "Bad query checksum");
+static_assert(radar_query(0x01, 0x02).bytes[QUERY_SIZE - 3] == 0xBF,
+              "Bad query checksum");
+
+/*
+Frame handlers by control word and command word
+Lookup index is generated at compile time.
+*/
+struct Radar_Routes {
+  typedef Radar_MR24HPC1::Route Route;
+
+  static constexpr uint8_t COUNT = 50;
+
+  static constexpr Route list[COUNT] = {
+    {0x01, 0x01, &Radar_MR24HPC1::run_01_cmd_0x01},
+    {0x01, 0x02, &Radar_MR24HPC1::run_01_cmd_0x02},
+    {0x02, 0xA1, &Radar_MR24HPC1::run_02_cmd_0xA1},
+    {0x02, 0xA2, &Radar_MR24HPC1::run_02_cmd_0xA2},
+    {0x02, 0xA3, &Radar_MR24HPC1::run_02_cmd_0xA3},
+    {0x02, 0xA4, &Radar_MR24HPC1::run_02_cmd_0xA4},
+    {0x03, 0x01, &Radar_MR24HPC1::run_03},
+    {0x03, 0x02, &Radar_MR24HPC1::run_03},
+    {0x03, 0x03, &Radar_MR24HPC1::run_03},
+    {0x05, 0x01, &Radar_MR24HPC1::run_05_cmd_0x01},
+    {0x05, 0x07, &Radar_MR24HPC1::run_05_cmd_0x07},
+    {0x05, 0x08, &Radar_MR24HPC1::run_05_cmd_0x08},
+    {0x05, 0x09, &Radar_MR24HPC1::run_05_cmd_0x09},
+    {0x05, 0x0A, &Radar_MR24HPC1::run_05_cmd_0x0A},
+    {0x05, 0x81, &Radar_MR24HPC1::run_05_cmd_0x81},
+    {0x05, 0x85, &Radar_MR24HPC1::run_05_cmd_0x85},
+    {0x05, 0x87, &Radar_MR24HPC1::run_05_cmd_0x87},
+    {0x05, 0x88, &Radar_MR24HPC1::run_05_cmd_0x88},
+    {0x05, 0x89, &Radar_MR24HPC1::run_05_cmd_0x89},
+    {0x08, 0x00, &Radar_MR24HPC1::run_08_cmd_0x00},
+    {0x08, 0x01, &Radar_MR24HPC1::run_08_cmd_0x01},
+    {0x08, 0x08, &Radar_MR24HPC1::run_08_cmd_0x08},
+    {0x08, 0x09, &Radar_MR24HPC1::run_08_cmd_0x09},
+    {0x08, 0x0A, &Radar_MR24HPC1::run_08_cmd_0x0A},
+    {0x08, 0x0B, &Radar_MR24HPC1::run_08_cmd_0x0B},
+    {0x08, 0x0C, &Radar_MR24HPC1::run_08_cmd_0x0C},
+    {0x08, 0x0D, &Radar_MR24HPC1::run_08_cmd_0x0D},
+    {0x08, 0x0E, &Radar_MR24HPC1::run_08_cmd_0x0E},
+    {0x08, 0x80, &Radar_MR24HPC1::run_08_cmd_0x80},
+    {0x08, 0x81, &Radar_MR24HPC1::run_08_cmd_0x81},
+    {0x08, 0x82, &Radar_MR24HPC1::run_08_cmd_0x82},
+    {0x08, 0x83, &Radar_MR24HPC1::run_08_cmd_0x83},
+    {0x08, 0x84, &Radar_MR24HPC1::run_08_cmd_0x84},
+    {0x08, 0x88, &Radar_MR24HPC1::run_08_cmd_0x88},
+    {0x08, 0x89, &Radar_MR24HPC1::run_08_cmd_0x89},
+    {0x08, 0x8A, &Radar_MR24HPC1::run_08_cmd_0x8A},
+    {0x08, 0x8B, &Radar_MR24HPC1::run_08_cmd_0x8B},
+    {0x08, 0x8C, &Radar_MR24HPC1::run_08_cmd_0x8C},
+    {0x08, 0x8D, &Radar_MR24HPC1::run_08_cmd_0x8D},
+    {0x08, 0x8E, &Radar_MR24HPC1::run_08_cmd_0x8E},
+    {0x80, 0x01, &Radar_MR24HPC1::run_80_cmd_0x01},
+    {0x80, 0x02, &Radar_MR24HPC1::run_80_cmd_0x02},
+    {0x80, 0x03, &Radar_MR24HPC1::run_80_cmd_0x03},
+    {0x80, 0x0A, &Radar_MR24HPC1::run_80_cmd_0x0A},
+    {0x80, 0x0B, &Radar_MR24HPC1::run_80_cmd_0x0B},
+    {0x80, 0x81, &Radar_MR24HPC1::run_80_cmd_0x81},
+    {0x80, 0x82, &Radar_MR24HPC1::run_80_cmd_0x82},
+    {0x80, 0x83, &Radar_MR24HPC1::run_80_cmd_0x83},
+    {0x80, 0x8A, &Radar_MR24HPC1::run_80_cmd_0x8A},
+    {0x80, 0x8B, &Radar_MR24HPC1::run_80_cmd_0x8B},
+  };
+
+  /*
+  Control words 0x01 0x02 0x03 0x05 0x08 0x80 go to rows 0-7,
+  command words 0x00-0x0F and 0x80-0x8F or 0xA0-0xAF to columns 0-31.
+  */
+  static constexpr uint8_t key(uint8_t control_word, uint8_t cmd_word) {
+    return static_cast<uint8_t>(
+      (((control_word + (control_word >> 5)) & 0x07) << 5) |
+      ((cmd_word >> 3) & 0x10) | (cmd_word & 0x0F));
+  }
+
+  static constexpr uint8_t route_key(uint8_t i) {
+    return key(list[i].control_word, list[i].cmd_word);
+  }
+
+  // Route number + 1 for key, 0 if none
+  static constexpr uint8_t find(uint8_t k, uint8_t i) {
+    return i >= COUNT ? 0 : (route_key(i) == k ? i + 1 : find(k, i + 1));
+  }
+
+  static constexpr bool is_unique(uint8_t i, uint8_t j) {
+    return j >= COUNT ? true :
+      (route_key(i) != route_key(j) && is_unique(i, j + 1));
+  }
+
+  static constexpr bool all_unique(uint8_t i) {
+    return i >= COUNT ? true : (is_unique(i, i + 1) && all_unique(i + 1));
+  }
+};
+
+constexpr Radar_Routes::Route Radar_Routes::list[];
+
+static_assert(Radar_Routes::all_unique(0), "Radar route keys collide");
+static_assert(Radar_Routes::COUNT <= COUNTER_COMMANDS,
+              "COUNTER_COMMANDS is smaller than routes table");
+
+template <uint16_t... I> struct Radar_Seq {};
+template <uint16_t N, uint16_t... I>
+struct Radar_MakeSeq : Radar_MakeSeq<N - 1, N - 1, I...> {};
+template <uint16_t... I>
+struct Radar_MakeSeq<0, I...> {
+  typedef Radar_Seq<I...> type;
+};
+
+struct Radar_RouteIndex {
+  uint8_t route[256];
+};
+
+struct Radar_RouteList {
+  Radar_Routes::Route route[Radar_Routes::COUNT];
+};
+
+template <uint16_t... I>
+constexpr Radar_RouteIndex make_route_index(Radar_Seq<I...>) {
+  return Radar_RouteIndex{{Radar_Routes::find(I, 0)...}};
+}
+
+template <uint16_t... I>
+constexpr Radar_RouteList make_route_list(Radar_Seq<I...>) {
+  return Radar_RouteList{{Radar_Routes::list[I]...}};
+}
+
+// Both tables are in flash
+static const Radar_RouteIndex route_index PROGMEM =
+  make_route_index(Radar_MakeSeq<256>::type());
+static const Radar_RouteList route_list PROGMEM =
+  make_route_list(Radar_MakeSeq<Radar_Routes::COUNT>::type());
+
+
+/*
+  Receive radar frames and store them in frames queue
+  Consumes only bytes that are already available, never blocks.
+  Stops when the queue is full, the rest stays in stream
+  until frames are processed.
+*/
 void Radar_MR24HPC1::read() {
-  unsigned char buffer[FRAME_SIZE] = {0};
-  uint8_t buff_len = 0;
-
-  // save to buffer
-  while (stream->available()) {
-    // Frame start bytes
-    if (stream->read() == HEAD1) {
-      if (stream->read() == HEAD2) {
-        // Read data
-        // What if data is 0x43?? then its stops!!
-        buff_len = stream->readBytesUntil(END2, buffer, FRAME_SIZE);
-        // buff_len = stream->readBytes(buffer, DATA_SIZE);
-        // Kontrollida kas viimane element on õige:
-        // if (buffer[buff_len-1] != END1) {
-        //  Serial.print(" !! False end !! ");
-        //}
-        if (buff_len > 0 && buff_len < FRAME_SIZE) {
-          buffer[buff_len] = END2;  // add last end byte
-        }
+  if (rx_ring != nullptr) {
+    read_ring();
+    return;
+  }
+
+  uint32_t bytes = 0;
+
+  // Raw capture of bytes read
+  bool raw = recorder != nullptr && recorder->is_raw();
+  uint8_t raw_bytes[FRAME_SIZE];
+  uint8_t raw_len = 0;
+
+  while (stream->available() > 0) {
+    if (replay_pos < replay_len) {
+      if (!parse_replay()) {
+        break;  // Queue is full
+      }
+    } else if (frames_count >= FRAME_QUEUE_SIZE) {
+      break;
+    }
+
+    int c = stream->read();
+
+    if (c < 0) {
+      break;
+    }
+
+    bytes++;
+    if (raw) {
+      raw_bytes[raw_len++] = static_cast<uint8_t>(c);
+      if (raw_len == FRAME_SIZE) {
+        recorder->record_bytes(raw_bytes, raw_len);
+        raw_len = 0;
       }
     }
+
+    if (parse_byte(static_cast<uint8_t>(c))) {
+      frames_count++;
+    }
   }
 
-  // Save to data_frame
-  // Add headers
-  frame[0] = HEAD1;
-  frame[1] = HEAD2;
+  if (raw_len > 0) {
+    recorder->record_bytes(raw_bytes, raw_len);
+  }
 
-  for (int i = 0; i < buff_len+1; i++) {  // +1 end2 byte
-    frame[i+2] = buffer[i];
+  if (replay_pos < replay_len) {
+    parse_replay();
   }
 
-  // Checksum
-  if (is_frame_good(frame)) {
-    // Serial.print("Good: ");
-    frame_len = buff_len + 3;
-    is_new_frame = true;
-  } else {
-  // Serial.println(" Bad: ");
+  if (counters != nullptr) {
+    counters->add_bytes(bytes);
+  }
+}
+
+/*
+  Receive frames from the interrupt fed byte ring
+  Parses bytes in place, without Stream calls.
+*/
+void Radar_MR24HPC1::read_ring() {
+  const uint8_t *data;
+  size_t len;
+
+  while ((len = rx_ring->peek(&data)) > 0) {
+    size_t used = feed(data, len);
+    rx_ring->consume(used);
+
+    if (used < len) {
+      break;  // Queue is full
+    }
+  }
+}
+
+/*
+  Give received bytes straight to the frame parser
+  Stops when the frames queue is full.
+  Returns how many bytes were used.
+*/
+size_t Radar_MR24HPC1::feed(const uint8_t *data, size_t len) {
+  size_t i = 0;
+
+  while (i < len) {
+    if (replay_pos < replay_len) {
+      if (!parse_replay()) {
+        break;  // Queue is full
+      }
+    } else if (frames_count >= FRAME_QUEUE_SIZE) {
+      break;
+    }
+
+    if (parse_byte(data[i++])) {
+      frames_count++;
+    }
+  }
+
+  if (replay_pos < replay_len) {
+    parse_replay();
+  }
+
+  if (recorder != nullptr) {
+    recorder->record_bytes(data, i);
+  }
+  if (counters != nullptr) {
+    counters->add_bytes(i);
+  }
+  return i;
+}
+
+/*
+  Read bytes from ring instead of stream
+  ring - filled by UART RX interrupt or reader thread, nullptr to stop
+*/
+void Radar_MR24HPC1::set_rx_ring(Radar_RxRing *ring) {
+  rx_ring = ring;
+}
+
+/*
+  Take the oldest frame from queue
+  f - view into the queue slot, valid until next read()
+  Returns false if queue is empty.
+*/
+bool Radar_MR24HPC1::next_frame(Radar_Frame &f) {
+  if (frames_count == 0) {
+    return false;
+  }
+
+  f = Radar_Frame(frames[frames_head], frames_len[frames_head]);
+
+  frames_head = (frames_head + 1) % FRAME_QUEUE_SIZE;
+  frames_count--;
+  return true;
+}
+
+/*
+  Frame parser state machine, takes one byte at a time.
+  Uses length bytes to know where frame ends,
+  so data bytes 0x43 or 0x53 don't break it.
+  Frame is assembled straight into the free queue slot.
+  Broken frame is scanned again from its next 0x53 by resync().
+  Returns true when slot holds a complete and valid frame.
+*/
+bool Radar_MR24HPC1::parse_byte(uint8_t byte) {
+  uint8_t slot = (frames_head + frames_count) % FRAME_QUEUE_SIZE;
+  unsigned char *rx = frames[slot];
+
+  if (rx_len == I_HEAD1) {
+    // Wait for frame start
+    if (byte == HEAD1) {
+      rx[rx_len++] = byte;
+    } else {
+      rx_skipped++;
+    }
+    return false;
+  }
+
+  if (rx_len == I_HEAD2) {
+    if (byte == HEAD2) {
+      rx[rx_len++] = byte;
+    } else if (byte != HEAD1) {
+      rx_len = 0;
+      rx_skipped += 2;
+    } else {
+      rx_skipped++;  // 0x53 0x53 0x59 is still a good start
+    }
+    return false;
+  }
+
+  rx[rx_len++] = byte;
+
+  if (rx_len == I_DATA) {
+    // Length bytes received
+    rx_expected = get_data_len(rx) + FRAME_OVERHEAD;
+    if (rx_expected > FRAME_SIZE) {
+      // Can't be a real frame
+      rx_len = 0;
+      if (counters != nullptr) {
+        counters->add_truncated();
+      }
+      if (recorder != nullptr) {
+        recorder->record_frame(rx, I_DATA, CAPTURE_RX | CAPTURE_BAD);
+      }
+      resync(rx, I_DATA);
+    }
+    return false;
+  }
+
+  if (rx_len < I_DATA || rx_len < rx_expected) {
+    return false;
+  }
+
+  // Frame complete
+  rx_len = 0;
+
+  bool tail_good = rx[rx_expected - 2] == END1 && rx[rx_expected - 1] == END2;
+
+  if (!tail_good || !is_frame_good(rx)) {
+    if (counters != nullptr) {
+      if (tail_good) {
+        counters->add_checksum_error();
+      } else {
+        counters->add_truncated();  // Bytes were lost
+      }
+    }
+    if (recorder != nullptr) {
+      recorder->record_frame(rx, rx_expected, CAPTURE_RX | CAPTURE_BAD);
+    }
+    resync(rx, rx_expected);
+    return false;
+  }
+
+  if (recorder != nullptr) {
+    recorder->record_frame(rx, rx_expected, CAPTURE_RX);
+  }
+
+  if (counters != nullptr) {
+    counters->add_frame();
   }
+
+  if (rx_skipped > 0) {
+    // First good frame after lost bytes
+    last_discarded = rx_skipped;
+    if (counters != nullptr) {
+      counters->add_resync(rx_skipped);
+    }
+    rx_skipped = 0;
+  }
+
+  frames_len[slot] = rx_expected;
+  return true;
+}
+
+/*
+  Broken frame: header was false or bytes were lost.
+  Next frame may start inside it, so bytes from the next 0x53
+  are kept and parsed again before new bytes.
+  Bytes before it are discarded.
+*/
+void Radar_MR24HPC1::resync(const unsigned char *rx, uint8_t len) {
+  uint8_t from = 1;
+
+  while (from < len && rx[from] != HEAD1) {
+    from++;
+  }
+  rx_skipped += from;
+
+  // Broken frame came from replay if there is some left,
+  // so both fit in the replay buffer.
+  uint8_t keep = len - from;
+  uint8_t rest = replay_len - replay_pos;
+  if (keep + rest > FRAME_SIZE) {
+    rest = FRAME_SIZE - keep;
+  }
+
+  memmove(&replay[keep], &replay[replay_pos], rest);
+  memcpy(replay, &rx[from], keep);
+  replay_len = keep + rest;
+  replay_pos = 0;
+}
+
+/*
+  Parse bytes kept by resync()
+  Returns false if the frames queue is full.
+*/
+bool Radar_MR24HPC1::parse_replay() {
+  while (replay_pos < replay_len) {
+    if (frames_count >= FRAME_QUEUE_SIZE) {
+      return false;
+    }
+
+    if (parse_byte(replay[replay_pos++])) {
+      frames_count++;
+    }
+  }
+
+  return frames_count < FRAME_QUEUE_SIZE;
 }
 
 
 /*
 Print radar data on serial monitor
 mode: HEX, DEC
-Adds headers
+Prints and removes all frames in queue
 */
 void Radar_MR24HPC1::print(int mode) {
-  if (is_new_frame) {
+  Radar_Frame f;
+
+  while (next_frame(f)) {
     switch (mode) {
       case DEC:
-        print_dec(frame, frame_len);
+        print_dec(f.raw(), f.size());
         break;
       default:
-        print_hex(frame, frame_len);
+        print_hex(f.raw(), f.size());
         break;
     }
-    is_new_frame = false;
-    frame[frame_len] = {0};  // set all data to zero
   }
 }
 
@@ -117,77 +527,307 @@ void Radar_MR24HPC1::print_dec(const unsigned char* buff, int len) {
 Send query to radar
 frame - array of bytes
 len - num of bytes
+Returns request handle, done when response frame is received
 */
-void Radar_MR24HPC1::send_query(const unsigned char *frame, int len) {
+Radar_Request Radar_MR24HPC1::send_query(const unsigned char *frame, int len) {
   // print_hex(frame, len);
-  stream->write(frame, len);
-  stream->flush();
+  if (recorder != nullptr) {
+    recorder->record(frame, len, CAPTURE_TX);
+  }
+
+  if (batch_depth > 0) {
+    if (tx_len + len > TX_BUFFER_SIZE) {
+      write_batch();  // Full, send what we have
+    }
+    memcpy(&tx_buffer[tx_len], frame, len);
+    tx_len += len;
+  } else {
+    stream->write(frame, len);
+    if (flush_each) {
+      stream->flush();
+    }
+  }
+
+  if (in_transaction) {
+    return Radar_Request();  // Only commit() is tracked
+  }
+
+  return add_request(frame[I_CONTROL_WORD], frame[I_CMD_WORD]);
+}
+
+/*
+Send fixed query from flash
+*/
+Radar_Request Radar_MR24HPC1::send_query_P(const Radar_Query *query) {
+  Radar_Query q;
+  memcpy_P(&q, query, sizeof(q));
+  return send_query(q.bytes, QUERY_SIZE);
+}
+
+/*
+Collect next queries to one buffer
+They are sent with one write by end_batch()
+Batches nest, only the outermost end_batch() writes.
+*/
+void Radar_MR24HPC1::begin_batch() {
+  if (batch_depth < 255) {
+    batch_depth++;
+  }
+}
+
+/*
+Send collected queries
+flush - wait until all bytes are sent
+*/
+void Radar_MR24HPC1::end_batch(bool flush) {
+  if (batch_depth == 0) {
+    return;
+  }
+  if (--batch_depth > 0) {
+    return;  // Outer batch sends
+  }
+
+  write_batch();
+
+  if (flush) {
+    stream->flush();
+  }
+}
+
+/*
+Write TX buffer to stream
+*/
+void Radar_MR24HPC1::write_batch() {
+  if (tx_len > 0) {
+    stream->write(tx_buffer, tx_len);
+    tx_len = 0;
+  }
+}
+
+/*
+Wait until every single query is sent, default true
+*/
+void Radar_MR24HPC1::set_flush(bool flush) {
+  flush_each = flush;
+}
+
+/*
+Remember sent query until response or timeout
+Same query already waiting shares its slot and gets a new deadline.
+Otherwise uses a slot that is not pending.
+Returns invalid request if all slots are pending.
+*/
+Radar_Request Radar_MR24HPC1::add_request(uint8_t control_word,
+                                          uint8_t cmd_word) {
+  update_requests();
+
+  for (uint8_t i = 0; i < REQUEST_SLOTS; i++) {
+    Pending &p = requests[i];
+
+    if (p.status == REQUEST_PENDING
+        && p.control_word == control_word && p.cmd_word == cmd_word) {
+      p.sent = millis();
+      p.timeout = request_timeout;
+      return Radar_Request(i, p.id);
+    }
+  }
+
+  for (uint8_t i = 0; i < REQUEST_SLOTS; i++) {
+    Pending &p = requests[i];
+
+    if (p.status == REQUEST_PENDING) {
+      continue;
+    }
+
+    request_id++;
+    if (request_id == 0) {
+      request_id = 1;  // 0 is invalid request
+    }
+
+    p.control_word = control_word;
+    p.cmd_word = cmd_word;
+    p.id = request_id;
+    p.status = REQUEST_PENDING;
+    p.sent = millis();
+    p.timeout = request_timeout;
+    requests_pending++;
+
+    return Radar_Request(i, p.id);
+  }
+
+  return Radar_Request();
+}
+
+/*
+Response frame received
+Completes pending request with same control and command word
+*/
+void Radar_MR24HPC1::complete_request(uint8_t control_word,
+                                      uint8_t cmd_word) {
+  for (uint8_t i = 0; i < REQUEST_SLOTS; i++) {
+    Pending &p = requests[i];
+
+    if (p.status == REQUEST_PENDING
+        && p.control_word == control_word && p.cmd_word == cmd_word) {
+      p.status = REQUEST_DONE;
+      requests_pending--;
+      return;
+    }
+  }
+}
+
+/*
+Mark requests without response as timed out
+*/
+void Radar_MR24HPC1::update_requests() {
+  if (requests_pending == 0) {
+    return;
+  }
+
+  unsigned long now = millis();
+
+  for (uint8_t i = 0; i < REQUEST_SLOTS; i++) {
+    Pending &p = requests[i];
+
+    if (p.status == REQUEST_PENDING && now - p.sent >= p.timeout) {
+      p.status = REQUEST_TIMEOUT;
+      requests_pending--;
+    }
+  }
+}
+
+/*
+ms until first pending request times out, -1 if none
+For event loops that sleep until something is due.
+*/
+long Radar_MR24HPC1::time_to_deadline() {
+  if (requests_pending == 0) {
+    return -1;
+  }
+
+  unsigned long now = millis();
+  long wait = -1;
+
+  for (uint8_t i = 0; i < REQUEST_SLOTS; i++) {
+    const Pending &p = requests[i];
+
+    if (p.status == REQUEST_PENDING) {
+      long left = static_cast<long>(p.sent + p.timeout - now);
+      if (left < 0) {
+        left = 0;
+      }
+      if (wait < 0 || left < wait) {
+        wait = left;
+      }
+    }
+  }
+
+  return wait;
+}
+
+/*
+Returns request status:
+REQUEST_PENDING - waiting for response
+REQUEST_DONE    - response received and processed
+REQUEST_TIMEOUT - no response before deadline
+REQUEST_ERROR   - invalid request or slot is already reused
+*/
+uint8_t Radar_MR24HPC1::get_request_status(Radar_Request req) {
+  if (req.id == 0 || req.slot >= REQUEST_SLOTS
+      || requests[req.slot].id != req.id) {
+    return REQUEST_ERROR;
+  }
+
+  update_requests();
+  return requests[req.slot].status;
+}
+
+/*
+Runs run() until response is received or request times out
+Returns true if response was received.
+*/
+bool Radar_MR24HPC1::wait(Radar_Request req, bool mode) {
+  while (get_request_status(req) == REQUEST_PENDING) {
+    run(mode);
+  }
+
+  return get_request_status(req) == REQUEST_DONE;
+}
+
+/*
+Response deadline for next queries in ms
+*/
+void Radar_MR24HPC1::set_request_timeout(uint16_t timeout_ms) {
+  request_timeout = timeout_ms;
 }
 
 /*
 Send Reset frame
 */
 void Radar_MR24HPC1::reset() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x01, 0x02, 0x00, 0x01, 0x0F, 0xBF, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+  send_query_P(&QUERY_01_02);
 }
 
 /*
 Send heartbeat frame
 */
-void Radar_MR24HPC1::ask_heartbeat() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x01, 0x01, 0x00, 0x01, 0x0F, 0x5F, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_heartbeat() {
+  return send_query_P(&QUERY_01_01);
 }
 
 /*
 Send product_model frame
 */
-void Radar_MR24HPC1::ask_product_model() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x02, 0xA1, 0x00, 0x01, 0x0F, 0xBE, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_product_model() {
+  return send_query_P(&QUERY_02_A1);
 }
 
 /*
 Send product id frame
 */
-void Radar_MR24HPC1::ask_product_id() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x02, 0xA2, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_product_id() {
+  return send_query_P(&QUERY_02_A2);
 }
 
 /*
 Send harware model frame
 */
-void Radar_MR24HPC1::ask_hardware_model() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x02, 0xA3, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_hardware_model() {
+  return send_query_P(&QUERY_02_A3);
 }
 
 /*
 Send firmware_version frame
 */
-void Radar_MR24HPC1::ask_firmware_version() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x02, 0xA4, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_firmware_version() {
+  return send_query_P(&QUERY_02_A4);
+}
+
+/*
+Ask product info that is not yet received, with one write
+Returns request of last query, answers come in order.
+Invalid request if all is already known, see has_device_info().
+*/
+Radar_Request Radar_MR24HPC1::ask_device_info() {
+  Radar_Request req;
+
+  begin_batch();  // Caller may batch more queries
+
+  if (!(info.received & INFO_PRODUCT_MODEL)) {
+    req = ask_product_model();
+  }
+  if (!(info.received & INFO_PRODUCT_ID)) {
+    req = ask_product_id();
+  }
+  if (!(info.received & INFO_HARDWARE_MODEL)) {
+    req = ask_hardware_model();
+  }
+  if (!(info.received & INFO_FIRMWARE_VERSION)) {
+    req = ask_firmware_version();
+  }
+
+  end_batch();
+  return req;
 }
 
 /*
@@ -211,31 +851,17 @@ Motion trigger boundary settings
 0x0A 5.0m
 */
 void Radar_MR24HPC1::set_motion_limit(uint8_t limit) {
-  // Start custom mode
-  start_custom_mode_settings(1);
-
-  const int len = 10;
-
   if (mode == ADVANCED) {
     if (limit > 0x0A) {
       limit = 0x0A;
     }
-    uint8_t frame_a[len] = {
-      HEAD1, HEAD2, 0x08, 0x0B, 0x00, 0x01, limit, 0x00, END1, END2};
-    frame_a[I_DATA+1] = get_frame_sum(frame_a, len);
-    send_query(frame_a, len);
+    send_setting(0x08, 0x0B, limit);
   } else {
     if (limit < 1 || limit > 4) {
       limit = 0x01;
     }
-    uint8_t frame_s[len] = {
-      HEAD1, HEAD2, 0x05, 0x07, 0x00, 0x01, limit, 0x00, END1, END2};
-    frame_s[I_DATA+1] = get_frame_sum(frame_s, len);
-    send_query(frame_s, len);
+    send_setting(0x05, 0x07, limit);
   }
-
-  // save
-  end_custom_mode_settings();
 }
 
 /*
@@ -258,44 +884,25 @@ Existence perception boundary settings
 0x0A 5.0m
 */
 void Radar_MR24HPC1::set_static_limit(uint8_t limit) {
-  // Start custom mode
-  start_custom_mode_settings(1);
-
-  const int len = 10;
-
   if (mode == ADVANCED) {
     if (limit > 0x0A) {
       limit = 0x0A;  // default
     }
-    uint8_t frame[len] = {
-      HEAD1, HEAD2, 0x08, 0x0A, 0x00, 0x01, limit, 0x00, END1, END2};
-    frame[I_DATA+1] = get_frame_sum(frame, len);
-    send_query(frame, len);
+    send_setting(0x08, 0x0A, limit);
   } else {
     if (limit < 1 || limit > 3) {
       limit = 0x03;  // default
     }
-    uint8_t frame[len] = {
-      HEAD1, HEAD2, 0x05, 0x08, 0x00, 0x01, limit, 0x00, END1, END2};
-    frame[I_DATA+1] = get_frame_sum(frame, len);
-    send_query(frame, len);
+    send_setting(0x05, 0x08, limit);
   }
-
-  // save
-  end_custom_mode_settings();
-  //reset();
 }
 
 
 /*
 Initialization status inquiry
 */
-void Radar_MR24HPC1::ask_initialization_status() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x05, 0x81, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_initialization_status() {
+  return send_query_P(&QUERY_05_81);
 }
 
 /*
@@ -310,40 +917,48 @@ Time for entering no person state setting
 0x07 30 min
 0x08 60 min
 */
-void Radar_MR24HPC1::set_absence_trigger_time(int time_ms) {
-  uint8_t hex[4] = {0};
-
-  if (time_ms < 0 || time_ms > 0xFFFFFF) {
+void Radar_MR24HPC1::set_absence_trigger_time(uint32_t time_ms) {
+  if (time_ms > 0xFFFFFF) {
     time_ms = 0;
   }
-  // Extract each byte from the time_ms value and store it in the hex array
-  for (int i = 3; i >= 0; i--) {
-    hex[i] = static_cast<unsigned char>(time_ms & 0xFF);
-    time_ms >>= 8; // Shift right by 8 bits to get the next byte
-  }
-
-  // Start custom mode
-  start_custom_mode_settings(1);
 
-  const int len = 13;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x80, 0x0A, 0x00, 0x01, hex[0], hex[1], hex[2], hex[3], 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+  if (mode == ADVANCED) {
+    send_setting(0x08, 0x0E, time_ms, true);  // Time in ms
+  } else {
+    send_setting(0x80, 0x0A, absence_time_code(time_ms));
+  }
+}
 
-  // save
-  end_custom_mode_settings();
+/*
+Time in ms to SIMPLE mode time for entering no person state
+Rounds up to the next setting
+*/
+uint8_t Radar_MR24HPC1::absence_time_code(uint32_t time_ms) {
+  if (time_ms == 0) {
+    return 0x00;
+  } else if (time_ms <= 10000UL) {
+    return TIME_10_S;
+  } else if (time_ms <= 30000UL) {
+    return TIME_30_S;
+  } else if (time_ms <= 60000UL) {
+    return TIME_60_S;
+  } else if (time_ms <= 2*60000UL) {
+    return TIME_2_MIN;
+  } else if (time_ms <= 5*60000UL) {
+    return TIME_5_MIN;
+  } else if (time_ms <= 10*60000UL) {
+    return TIME_10_MIN;
+  } else if (time_ms <= 30*60000UL) {
+    return TIME_30_MIN;
+  }
+  return TIME_60_MIN;
 }
 
 /*
 Presence information inquiry
 */
-void Radar_MR24HPC1::ask_presence() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x80, 0x81, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_presence() {
+  return send_query_P(&QUERY_80_81);
 }
 
 
@@ -351,46 +966,30 @@ void Radar_MR24HPC1::ask_presence() {
 Motion information inquiry
 none, static, active
 */
-void Radar_MR24HPC1::ask_motion() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x80, 0x82, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_motion() {
+  return send_query_P(&QUERY_80_82);
 }
 
 /*
 Body movment parameter inquiry
 activity - body parameter
 */
-void Radar_MR24HPC1::ask_activity() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x80, 0x83, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_activity() {
+  return send_query_P(&QUERY_80_83);
 }
 
 /*
 Time for entering no person state inquiry
 */
-void Radar_MR24HPC1::ask_absence_trigger_time() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x80, 0x8A, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_absence_trigger_time() {
+  return send_query_P(&QUERY_80_8A);
 }
 
 /*
 Proximity inquiry
 */
-void Radar_MR24HPC1::ask_direction() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x80, 0x8B, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_direction() {
+  return send_query_P(&QUERY_80_8B);
 }
 
 /*
@@ -398,46 +997,30 @@ Advandsed mode ==
 Underlying open function information
 output switch inquiry
 */
-void Radar_MR24HPC1::ask_mode() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x08, 0x80, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_mode() {
+  return send_query_P(&QUERY_08_80);
 }
 
 
 /*
 Static distance inquiry
 */
-void Radar_MR24HPC1::ask_static_body_distance() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x08, 0x83, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_static_body_distance() {
+  return send_query_P(&QUERY_08_83);
 }
 
 /*
 Motion distance inquiry
 */
-void Radar_MR24HPC1::ask_motion_body_distance() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x08, 0x84, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_motion_body_distance() {
+  return send_query_P(&QUERY_08_84);
 }
 
 /*
 Motion speed inquiry
 */
-void Radar_MR24HPC1::ask_motion_speed() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x05, 0x85, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_motion_speed() {
+  return send_query_P(&QUERY_05_85);
 }
 
 /*
@@ -448,12 +1031,8 @@ Advandsed Custom mode inquiry
 0x03 Custom mode 3
 0x04 Custom mode 4
 */
-void Radar_MR24HPC1::ask_custom_mode() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x05, 0x89, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+Radar_Request Radar_MR24HPC1::ask_custom_mode() {
+  return send_query_P(&QUERY_05_89);
 }
 
 /*
@@ -463,26 +1042,101 @@ Advandsed Custom mode setting
 0x03 Custom mode 3
 0x04 Custom mode 4
 */
-void Radar_MR24HPC1::start_custom_mode_settings(uint8_t mode) {
+Radar_Request Radar_MR24HPC1::start_custom_mode_settings(uint8_t mode) {
   if (mode > 0x04) {
     mode = 0x04;
   }
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x05, 0x09, 0x00, 0x01, mode, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+  Radar_Query query = radar_query(0x05, 0x09, mode);
+  shadow.send(0x05, 0x09, mode);
+  return send_query(query.bytes, QUERY_SIZE);
 }
 
 /*
 End Custom mode settings
+Returns request, done when radar has saved settings
+*/
+Radar_Request Radar_MR24HPC1::end_custom_mode_settings() {
+  return send_query_P(&QUERY_05_0A);
+}
+
+/*
+Setters start custom mode, unless transaction has already done it
+*/
+void Radar_MR24HPC1::begin_setting() {
+  if (!in_transaction) {
+    start_custom_mode_settings(1);
+  } else if (!transaction_started) {
+    start_custom_mode_settings(transaction_mode);  // First change
+    transaction_started = true;
+  }
+}
+
+/*
+Setters save custom mode, unless transaction does it on commit
 */
-void Radar_MR24HPC1::end_custom_mode_settings() {
-  const int len = 10;
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x05, 0x0A, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
+void Radar_MR24HPC1::end_setting() {
+  if (!in_transaction) {
+    end_custom_mode_settings();
+  }
+}
+
+/*
+Send setting frame in custom mode session
+Skipped if radar has confirmed the same value, so
+setting same values again sends nothing.
+wide - 4 data bytes
+*/
+void Radar_MR24HPC1::send_setting(uint8_t control_word, uint8_t cmd_word,
+                                  uint32_t value, bool wide) {
+  uint8_t mode = in_transaction ? transaction_mode : 1;  // See begin_setting()
+  if (shadow.is_set(control_word, cmd_word, value, mode)) {
+    return;
+  }
+
+  begin_setting();
+
+  if (wide) {
+    Radar_Query4 query = radar_query4(control_word, cmd_word, value);
+    send_query(query.bytes, QUERY4_SIZE);
+  } else {
+    Radar_Query query = radar_query(control_word, cmd_word,
+                                    static_cast<uint8_t>(value));
+    send_query(query.bytes, QUERY_SIZE);
+  }
+  shadow.send(control_word, cmd_word, value);
+
+  end_setting();
+}
+
+/*
+Setting or inquiry response: update shadow
+and report if radar has other value than set or known
+*/
+void Radar_MR24HPC1::update_setting(const Radar_Frame &f, bool mode) {
+  uint8_t control_word = f.control_word();
+  uint8_t cmd_word = f.cmd_word();
+  uint32_t value = f.data_len() == 4 ? f.u32(0) : f.u8(0);
+  uint32_t expected = 0;
+
+  if (shadow.receive(control_word, cmd_word, value, expected)
+      != SHADOW_DIVERGED) {
+    return;
+  }
+
+  if (divergence_callback != nullptr) {
+    divergence_callback(this, control_word, cmd_word, expected, value);
+  }
+
+  if (mode == VERBAL) {
+    logger.print("Setting 0x");
+    logger.print(control_word, HEX);
+    logger.print(" 0x");
+    logger.print(cmd_word & 0x7F, HEX);
+    logger.print(" is ");
+    logger.print(value);
+    logger.print(", expected ");
+    logger.println(expected);
+  }
 }
 
 /*
@@ -493,18 +1147,8 @@ void Radar_MR24HPC1::set_static_threshold(uint8_t limit) {
   if (limit > 250) {
     limit = 250;
   }
-  const int len = 10;
-
-  // Start custom mode
-  start_custom_mode_settings(1);
-
-  uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x08, 0x08, 0x00, 0x01, limit, 0x00, END1, END2};
-  frame[I_DATA+1] = get_frame_sum(frame, len);
-  send_query(frame, len);
 
-  // save
-  end_custom_mode_settings();
+  send_setting(0x08, 0x08, limit);
 }
 
 
@@ -513,53 +1157,28 @@ Motion trigger threshold settings
 Range 0-250
 */
 void Radar_MR24HPC1::set_motion_threshold(uint8_t limit) {
-  const int len = 10;
-
   if (limit > 250) {
     limit = 250;
   }
 
-  // Start custom mode
-  start_custom_mode_settings(1);
-
   if (mode == ADVANCED) {
     if (limit > 0x0A) {
       limit = 0x0A;
     }
-    uint8_t frame[len] = {
-      HEAD1, HEAD2, 0x08, 0x09, 0x00, 0x01, limit, 0x00, END1, END2};
-    frame[I_DATA+1] = get_frame_sum(frame, len);
-    send_query(frame, len);
-  } else {
-    if (limit > 250) {
-      limit = 250;
-    }
-    uint8_t frame[len] = {
-      HEAD1, HEAD2, 0x08, 0x09, 0x00, 0x01, limit, 0x00, END1, END2};
-    frame[I_DATA+1] = get_frame_sum(frame, len);
-    send_query(frame, len);
   }
-  // save
-  end_custom_mode_settings();
+
+  send_setting(0x08, 0x09, limit);
 }
 
 
 /*
 Existence judgment threshold inquiry
 */
-void Radar_MR24HPC1::ask_static_energy() {
-  const int len = 10;
-
+Radar_Request Radar_MR24HPC1::ask_static_energy() {
   if (mode == ADVANCED) {
-    uint8_t frame[len] = {
-      HEAD1, HEAD2, 0x08, 0x88, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-    frame[I_DATA+1] = get_frame_sum(frame, len);
-    send_query(frame, len);
+    return send_query_P(&QUERY_08_88);
   } else {
-    uint8_t frame[len] = {
-      HEAD1, HEAD2, 0x08, 0x81, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-    frame[I_DATA+1] = get_frame_sum(frame, len);
-    send_query(frame, len);
+    return send_query_P(&QUERY_08_81);
   }
 }
 
@@ -567,19 +1186,11 @@ void Radar_MR24HPC1::ask_static_energy() {
 Existence judgment threshold inquiry
 Motion energy value inquiry
 */
-void Radar_MR24HPC1::ask_motion_energy() {
-  const int len = 10;
-
+Radar_Request Radar_MR24HPC1::ask_motion_energy() {
   if (mode == ADVANCED) {
-    uint8_t frame[len] = {
-      HEAD1, HEAD2, 0x08, 0x89, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-    frame[I_DATA+1] = get_frame_sum(frame, len);
-    send_query(frame, len);
+    return send_query_P(&QUERY_08_89);
   } else {
-    uint8_t frame[len] = {
-      HEAD1, HEAD2, 0x80, 0x83, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-    frame[I_DATA+1] = get_frame_sum(frame, len);
-    send_query(frame, len);
+    return send_query_P(&QUERY_80_83);
   }
 }
 
@@ -587,19 +1198,11 @@ void Radar_MR24HPC1::ask_motion_energy() {
 Existence perception boundry inquiry
 Sensitivity settings inquiry
 */
-void Radar_MR24HPC1::ask_static_limit() {
-  const int len = 10;
-
+Radar_Request Radar_MR24HPC1::ask_static_limit() {
   if (mode == ADVANCED) {
-    uint8_t _frame[len] = {
-      HEAD1, HEAD2, 0x08, 0x8A, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-    _frame[I_DATA+1] = get_frame_sum(_frame, len);
-    send_query(_frame, len);
+    return send_query_P(&QUERY_08_8A);
   } else {
-    uint8_t _frame[len] = {
-      HEAD1, HEAD2, 0x05, 0x88, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-    _frame[I_DATA+1] = get_frame_sum(_frame, len);
-    send_query(_frame, len);
+    return send_query_P(&QUERY_05_88);
   }
 }
 
@@ -607,68 +1210,42 @@ void Radar_MR24HPC1::ask_static_limit() {
 Motion trigger boundry inquiry
 Scene settings inquiry
 */
-void Radar_MR24HPC1::ask_motion_limit() {
-  const int len = 10;
-
+Radar_Request Radar_MR24HPC1::ask_motion_limit() {
   if (mode == ADVANCED) {
-    uint8_t frame[len] = {
-      HEAD1, HEAD2, 0x08, 0x8B, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-    frame[I_DATA+1] = get_frame_sum(frame, len);
-    send_query(frame, len);
+    return send_query_P(&QUERY_08_8B);
   } else {
-    uint8_t frame[len] = {
-      HEAD1, HEAD2, 0x05, 0x87, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-    frame[I_DATA+1] = get_frame_sum(frame, len);
-    send_query(frame, len);
+    return send_query_P(&QUERY_05_87);
   }
 }
 
 /*
 Motion trigger time inquiry
 */
-void Radar_MR24HPC1::ask_motion_trigger_time() {
-  const int len = 10;
-
+Radar_Request Radar_MR24HPC1::ask_motion_trigger_time() {
   if (mode == ADVANCED) {
-    uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x08, 0x8C, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-    frame[I_DATA+1] = get_frame_sum(frame, len);
-    send_query(frame, len);
-  } else {
-    //
+    return send_query_P(&QUERY_08_8C);
   }
+  return Radar_Request();  // SIMPLE mode has no inquiry
 }
 
 /*
 Motion to still time inquiry
 */
-void Radar_MR24HPC1::ask_motion_to_static_time() {
-  const int len = 10;
-
+Radar_Request Radar_MR24HPC1::ask_motion_to_static_time() {
   if (mode == ADVANCED) {
-    uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x08, 0x8D, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-      frame[I_DATA+1] = get_frame_sum(frame, len);
-    send_query(frame, len);
-  } else {
-    //
+    return send_query_P(&QUERY_08_8D);
   }
+  return Radar_Request();  // SIMPLE mode has no inquiry
 }
 
 /*
 Time for entering no person state inquiry
 */
-void Radar_MR24HPC1::ask_no_person_time() {
-  const int len = 10;
-
+Radar_Request Radar_MR24HPC1::ask_no_person_time() {
   if (mode == ADVANCED) {
-    uint8_t frame[len] = {
-    HEAD1, HEAD2, 0x08, 0x8E, 0x00, 0x01, 0x0F, 0x00, END1, END2};
-      frame[I_DATA+1] = get_frame_sum(frame, len);
-    send_query(frame, len);
-  } else {
-    //
+    return send_query_P(&QUERY_08_8E);
   }
+  return Radar_Request();  // SIMPLE mode has no inquiry
 }
 
 /*
@@ -706,21 +1283,6 @@ float Radar_MR24HPC1::calculate_speed(int val) {
   return 0;
 }
 
-/*
-Takes time data in HEX array and retruns time in ms
-size - 4 bytes
-*/
-int Radar_MR24HPC1::calculate_time(const unsigned char hex[], int size) {
-  int decimal_value = 0;
-
-  for (int i = 0; i < 4; i++) {
-    decimal_value = (decimal_value << 8) | hex[i];
-  }
-
-  return decimal_value;  // ms
-}
-
-
 /*
  Converts the hexadecimal string to an integer
 */
@@ -748,223 +1310,421 @@ char Radar_MR24HPC1::hex_to_char(const unsigned char *hex) {
 
   char char_val = static_cast <char> (int_val);
 
-  return char_val;
+  return char_val;
+}
+
+/*
+ Calcutaltes checksum
+*/
+uint8_t Radar_MR24HPC1::calculate_sum(const unsigned char f[], int size) {
+  uint8_t sum = 0;
+
+  for (int i = 0; i < size; i++) {
+    sum += f[i];
+  }
+
+  return sum;
+}
+
+/*
+ Number of data bytes in frame
+*/
+uint16_t Radar_MR24HPC1::get_data_len(const unsigned char f[]) {
+  return (static_cast<uint16_t>(f[I_LENGHT_H]) << 8) | f[I_LENGHT_L];
+}
+
+/*
+ Compare data sum and calculated sum
+*/
+bool Radar_MR24HPC1::is_frame_good(const unsigned char f[]) {
+  uint16_t data_lenght = get_data_len(f);
+
+  int count = I_DATA + data_lenght;  // how many bytes total
+
+  uint8_t my_sum = calculate_sum(f, count);
+
+  uint8_t frame_sum = f[I_DATA + data_lenght];
+
+  if (frame_sum == my_sum) {
+    return true;
+  }
+
+  return false;
+}
+
+
+/*
+Set Radar Mode: 0 SIMPLE, 1 ADVANCED
+*/
+void Radar_MR24HPC1::set_mode(int newmode) {
+  if (newmode == SIMPLE) {
+    send_query_P(&QUERY_08_00_OFF);
+    mode = SIMPLE;
+  } else if (newmode == ADVANCED) {
+    send_query_P(&QUERY_08_00_ON);
+    mode = ADVANCED;
+  }
+}
+
+
+/*
+Runs on the loop
+Processes all received frames.
+max_frames - limit frames processed per call, 0 no limit
+*/
+void Radar_MR24HPC1::run(bool mode, uint8_t max_frames) {
+  process(mode, max_frames, true);
+}
+
+/*
+Processes frames given with feed() only, stream is not read
+For replay and tests on a radar that also has a live stream.
+*/
+void Radar_MR24HPC1::run_fed(bool mode, uint8_t max_frames) {
+  process(mode, max_frames, false);
+}
+
+/*
+Frames from stream (or ring) and feed()
+from_stream - false: only frames already fed
+*/
+void Radar_MR24HPC1::process(bool mode, uint8_t max_frames,
+                             bool from_stream) {
+  uint8_t count = 0;
+  Radar_Frame f;
+  unsigned long start = counters != nullptr ? micros() : 0;
+
+  if (from_stream) {
+    read();  // Read new frames
+  }
+
+  while (next_frame(f)) {
+    dispatch(f, mode);
+    logger.commit(this);  // Handler text as one write
+
+    if (requests_pending > 0) {
+      complete_request(f.control_word(), f.cmd_word());
+    }
+
+    if (snapshot != nullptr) {
+      Radar_State state;
+      get_state(state);
+      snapshot->publish(state);
+    }
+
+    count++;
+    if (max_frames > 0 && count >= max_frames) {
+      break;
+    }
+
+    if (from_stream) {
+      read();  // Queue has room again
+    } else if (replay_pos < replay_len) {
+      parse_replay();  // Rest of broken frame
+    }
+  }
+
+  logger.pump();  // Rest of text that did not fit before
+
+  if (counters != nullptr && count > 0) {
+    counters->add_run(micros() - start);
+  }
+}
+
+/*
+Call frame handler from routes table
+Unknown control and command word pairs are only counted
+*/
+void Radar_MR24HPC1::dispatch(const Radar_Frame &f, bool mode) {
+  uint8_t control_word = f.control_word();
+  uint8_t cmd_word = f.cmd_word();
+  uint8_t key = Radar_Routes::key(control_word, cmd_word);
+  uint8_t index = pgm_read_byte(&route_index.route[key]);
+
+  if (index > 0) {
+    Route route;
+    memcpy_P(&route, &route_list.route[index - 1], sizeof(route));
+
+    if (route.control_word == control_word && route.cmd_word == cmd_word) {
+      if (counters != nullptr) {
+        counters->add_command(index - 1, control_word, cmd_word);
+      }
+      (this->*route.handler)(f, mode);
+      return;
+    }
+  }
+
+  if (counters != nullptr) {
+    counters->add_unknown(control_word, cmd_word);
+  }
+}
+
+/*
+Publish state to snapshot after every frame
+s - read by other threads, nullptr to stop
+*/
+void Radar_MR24HPC1::set_snapshot(Radar_Snapshot *s) {
+  snapshot = s;
+}
+
+/*
+Add sensor reports and 0x80 presence and motion reports to history
+h - nullptr to stop
+*/
+void Radar_MR24HPC1::set_history(Radar_History *h) {
+  history = h;
+}
+
+/*
+Add energies and distances to running statistics
+s - nullptr to stop
+*/
+void Radar_MR24HPC1::set_stats(Radar_Stats *s) {
+  stats = s;
+}
+
+/*
+Call sensor report callback and print only fields that changed
+more than deadband
+d - nullptr to get every report
+*/
+void Radar_MR24HPC1::set_deadband(Radar_Deadband *d) {
+  deadband = d;
+}
+
+/*
+Write every sent and received frame to capture
+r - nullptr to stop
+*/
+void Radar_MR24HPC1::set_recorder(Radar_Recorder *r) {
+  recorder = r;
+}
+
+/*
+Count bytes, frames, errors and run() time
+c - read by other threads, nullptr to stop
+*/
+void Radar_MR24HPC1::set_counters(Radar_Counters *c) {
+  counters = c;
+}
+
+/*
+VERBAL text output, RADAR_LOG_BUFFERED only
+p - default Serial, nullptr drops text
+*/
+void Radar_MR24HPC1::set_log_output(Print *p) {
+  logger.set_output(p);
+}
+
+/*
+VERBAL text of every frame to function, RADAR_LOG_CALLBACK only
+*/
+void Radar_MR24HPC1::set_log_callback(Radar_LogCallback cb) {
+  logger.set_callback(cb);
+}
+
+/*
+Frames of VERBAL text that were dropped,
+output was busy or text was longer than buffer
+*/
+uint32_t Radar_MR24HPC1::get_log_dropped() {
+  return logger.get_dropped();
+}
+
+/*
+Product info from last responses
+*/
+const char *Radar_MR24HPC1::get_product_model() {
+  return info.product_model;
+}
+
+const char *Radar_MR24HPC1::get_product_id() {
+  return info.product_id;
+}
+
+const char *Radar_MR24HPC1::get_hardware_model() {
+  return info.hardware_model;
+}
+
+const char *Radar_MR24HPC1::get_firmware_version() {
+  return info.firmware_version;
+}
+
+bool Radar_MR24HPC1::has_device_info() {
+  return info.received == INFO_ALL;
+}
+
+const Radar_DeviceInfo &Radar_MR24HPC1::get_device_info() {
+  return info;
+}
+
+/*
+Copy all decoded values
+*/
+void Radar_MR24HPC1::get_state(Radar_State &state) {
+  state.mode = mode;
+  state.heartbeat = heartbeat;
+  state.presence = presence;
+  state.motion = motion;
+  state.activity = activity;
+  state.direction = direction;
+  state.static_energy = static_energy;
+  state.static_distance = static_distance;
+  state.motion_energy = motion_energy;
+  state.motion_distance = motion_distance;
+  state.motion_speed = motion_speed;
+  state.motion_trigger_limit = motion_trigger_limit;
+  state.static_trigger_limit = static_trigger_limit;
+  state.motion_energy_threshold = motion_energy_threshold;
+  state.static_energy_threshold = static_energy_threshold;
+  state.motion_trigger_time = motion_trigger_time;
+  state.motion_to_static_time = motion_to_static_time;
+  state.time_for_entering_no_person_state = time_for_entering_no_person_state;
+  state.custom_mode = custom_mode;
+  state.initialization_status = initialization_status;
+  state.updated = millis();
+}
+
+/*
+Returns how many frames had unknown control and command word
+Counted in Radar_Counters, 0 without set_counters()
+*/
+uint32_t Radar_MR24HPC1::get_unknown_frames() {
+  return counters != nullptr ? counters->get_unknown() : 0;
+}
+
+/*
+Returns how many times bytes were lost before a good frame:
+noise, broken frames or false headers
+Counted in Radar_Counters, 0 without set_counters()
+*/
+uint32_t Radar_MR24HPC1::get_resyncs() {
+  return counters != nullptr ? counters->get_resyncs() : 0;
+}
+
+/*
+Returns all bytes that were not part of a good frame
+Counted in Radar_Counters, 0 without set_counters()
+*/
+uint32_t Radar_MR24HPC1::get_discarded_bytes() {
+  return counters != nullptr ? counters->get_discarded() : 0;
+}
+
+/*
+Returns bytes lost before the last good frame after resync
+*/
+uint32_t Radar_MR24HPC1::get_last_discarded() {
+  return last_discarded;
 }
 
+
 /*
- Calcutaltes checksum
+Controll word 0x01
+Hearbeat
 */
-uint8_t Radar_MR24HPC1::calculate_sum(const unsigned char f[], int size) {
-  uint8_t sum = 0;
+void Radar_MR24HPC1::run_01_cmd_0x01(const Radar_Frame &f, bool mode) {
+  heartbeat++;
 
-  for (int i = 0; i < size; i++) {
-    sum += f[i];
+  if (heartbeat_callback != nullptr) {
+    heartbeat_callback(this, heartbeat);
   }
-
-  return sum;
 }
 
 /*
-Full frames in
+Controll word 0x01
+Reset
 */
-uint8_t Radar_MR24HPC1::get_frame_sum(uint8_t *frame, int len) {
-  unsigned int sum = 0;
-  for (int i = 0; i < len - 3; i++) {
-    sum += frame[i];
+void Radar_MR24HPC1::run_01_cmd_0x02(const Radar_Frame &f, bool mode) {
+  if (mode == VERBAL) {
+    logger.println("Radar Reset!");
   }
-  return sum & 0xff;
 }
 
 /*
- Compare data sum and calculated sum
+Copy product info text from frame
+text - INFO_TEXT_SIZE bytes
 */
-bool Radar_MR24HPC1::is_frame_good(const unsigned char f[]) {
-  unsigned char data_lenght_byte = f[I_LENGHT_L];
-
-  int count = I_DATA + data_lenght_byte;  // how many bytes total
-
-  uint8_t my_sum = calculate_sum(f, count);
-
-  uint8_t frame_sum = f[I_DATA + data_lenght_byte];
-
-  if (frame_sum == my_sum) {
-    return true;
+static void copy_info(const Radar_Frame &f, char *text) {
+  uint16_t len = f.data_len();
+  if (len > INFO_TEXT_SIZE - 1) {
+    len = INFO_TEXT_SIZE - 1;
   }
 
-  return false;
+  memcpy(text, f.data(), len);
+  text[len] = '\0';
 }
 
-
 /*
-Set Radar Mode: 0 SIMPLE, 1 ADVANCED
+Controll word 0x02
+Product Model
 */
-void Radar_MR24HPC1::set_mode(int newmode) {
-  const uint8_t cmd_len = 10;
-  const unsigned char on_cmd[cmd_len] = {
-    HEAD1, HEAD2, 0x08, 0x00, 0x00, 0x01, 0x01, 0xB6, END1, END2 };
-
-  const unsigned char off_cmd[cmd_len] = {
-    HEAD1, HEAD2, 0x08, 0x00, 0x00, 0x01, 0x00, 0xB5, END1, END2 };
+void Radar_MR24HPC1::run_02_cmd_0xA1(const Radar_Frame &f, bool mode) {
+  copy_info(f, info.product_model);
+  info.received |= INFO_PRODUCT_MODEL;
 
-  if (newmode == SIMPLE) {
-    stream->write(off_cmd, cmd_len);
-    stream->flush();
-    mode = SIMPLE;
-  } else if (newmode == ADVANCED) {
-    stream->write(on_cmd, cmd_len);
-    stream->flush();
-    mode = ADVANCED;
+  if (mode == VERBAL) {
+    logger.print("Product Model ");
+    logger.println(info.product_model);
   }
 }
 
-
 /*
-Runs on the loop 
+Product ID
 */
-void Radar_MR24HPC1::run(bool mode) {
-  read();  // Read new frames
+void Radar_MR24HPC1::run_02_cmd_0xA2(const Radar_Frame &f, bool mode) {
+  copy_info(f, info.product_id);
+  info.received |= INFO_PRODUCT_ID;
 
-  if (is_new_frame) {
-    int control_word = frame[I_CONTROL_WORD];
-
-    switch (control_word) {
-      case 0x01:
-        run_01(mode);
-        break;
-      case 0x02:
-        run_02(mode);
-        break;
-      case 0x03:
-        if (mode == VERBAL) {
-          Serial.println("Radar: UART upgrade");
-        }
-        break;
-      case 0x05:
-        run_05(mode);
-        break;
-      case 0x08:
-        run_08(mode);
-        break;
-      case 0x80:
-        run_80(mode);
-        break;
-      default:
-        // Serial.println("---Bad frame ---");
-        // print();
-        break;
-    }
+  if (mode == VERBAL) {
+    logger.print("Product ID ");
+    logger.println(info.product_id);
   }
 }
 
-
 /*
-Controll word 0x01
-Hearbeat, reset
+Hardware Model
 */
-void Radar_MR24HPC1::run_01(bool mode) {
-  int cmd_word = frame[I_CMD_WORD];
+void Radar_MR24HPC1::run_02_cmd_0xA3(const Radar_Frame &f, bool mode) {
+  copy_info(f, info.hardware_model);
+  info.received |= INFO_HARDWARE_MODEL;
 
-  switch (cmd_word) {
-    case 0x01:  // heartbeat
-      heartbeat++;
-      break;
-    case 0x02:  // reset
-      Serial.println("Radar Reset!");
-      break;
-    default:
-      break;
+  if (mode == VERBAL) {
+    logger.print("Hardware Model ");
+    logger.println(info.hardware_model);
   }
 }
 
 /*
-Controll word 0x02
-TODO: Product info
+Firmware version
 */
-void Radar_MR24HPC1::run_02(bool mode) {
-  int cmd_word = frame[I_CMD_WORD];
-  // int len = frame[I_LENGHT_L];
+void Radar_MR24HPC1::run_02_cmd_0xA4(const Radar_Frame &f, bool mode) {
+  copy_info(f, info.firmware_version);
+  info.received |= INFO_FIRMWARE_VERSION;
 
-  switch (cmd_word) {
-    case 0xA1:
-      Serial.print("Product Model ");
-      break;
-    case 0xA2:
-      Serial.print("Product ID ");
-      break;
-    case 0xA3:
-      Serial.print("Hardware Model ");
-      break;
-    case 0xA4:
-      Serial.print("Firmware version ");
-      break;
-    default:
-      print();
-      break;
+  if (mode == VERBAL) {
+    logger.print("Firmware version ");
+    logger.println(info.firmware_version);
   }
 }
 
 /*
-Controll word 0x05
-Work status
+Controll word 0x03
+UART upgrade
 */
-void Radar_MR24HPC1::run_05(bool mode) {
-  int cmd_word = frame[I_CMD_WORD];
-
-  switch (cmd_word) {
-    case 0x01:
-      // Work status: init completed
-      run_05_cmd_0x01(mode);
-      break;
-    case 0x07:
-      // Motion limit response
-      run_05_cmd_0x07(mode);
-      break;
-    case 0x08:
-      // Static limit response
-      run_05_cmd_0x08(mode);
-      break;
-    case 0x09:
-      // Custom mode setting
-      run_05_cmd_0x09(mode);
-      break;
-    case 0x81:
-      // Initializatio status inquiry response
-      run_05_cmd_0x81(mode);
-      break;
-    case 0x85:
-      // Motion speed inquiry response
-      run_05_cmd_0x85(mode);
-      break;
-    case 0x87:
-      // Scene settings inquiry response
-      run_05_cmd_0x87(mode);
-      break;
-    case 0x88:
-      // Static limit settings response
-      run_05_cmd_0x88(mode);
-      break;
-    case 0x89:
-      // Custom mode inquiry
-      run_05_cmd_0x89(mode);
-      break;
-    case 0x0A:
-      // End of ustom mode setting response
-      run_05_cmd_0x0A(mode);
-      break;
-    default:
-      print();
-      break;
+void Radar_MR24HPC1::run_03(const Radar_Frame &f, bool mode) {
+  if (mode == VERBAL) {
+    logger.println("Radar: UART upgrade");
   }
 }
 
 /*
 Initialization completed
 */
-void Radar_MR24HPC1::run_05_cmd_0x01(bool mode) {
-  initialization_status = 0x01;  // frame[I_DATA];  // Completed
+void Radar_MR24HPC1::run_05_cmd_0x01(const Radar_Frame &f, bool mode) {
+  initialization_status = 0x01;  // f.u8(0);  // Completed
 
   if (mode == VERBAL) {
-    Serial.println("Initialization completed.");
+    logger.println("Initialization completed.");
   }
 }
 
@@ -972,27 +1732,29 @@ void Radar_MR24HPC1::run_05_cmd_0x01(bool mode) {
 Scene settings limit response
 Motion trigger limit response
 */
-void Radar_MR24HPC1::run_05_cmd_0x07(bool mode) {
-  if (frame[I_DATA] == 0x01) {
+void Radar_MR24HPC1::run_05_cmd_0x07(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  if (f.u8(0) == 0x01) {
     // Living room 4-4.5m
     motion_trigger_limit = 450;  // cm
-  } else if (frame[I_DATA] == 0x02) {
+  } else if (f.u8(0) == 0x02) {
     // Bedroom 4m
     motion_trigger_limit = 400;  // cm
-  } else if (frame[I_DATA] == 0x03) {
+  } else if (f.u8(0) == 0x03) {
     // Bathroom 3m
     motion_trigger_limit = 300;  // cm
-  } else if (frame[I_DATA] == 0x04) {
+  } else if (f.u8(0) == 0x04) {
     // area detection 3.5m
     motion_trigger_limit = 350;  // cm
-  } else if (frame[I_DATA] == 0x00) {
+  } else if (f.u8(0) == 0x00) {
     motion_trigger_limit = 0;
   }
 
   if (mode == VERBAL) {
-    Serial.print("Motion trigger limit: ");
-    Serial.print(motion_trigger_limit);
-    Serial.println(" cm");
+    logger.print("Motion trigger limit: ");
+    logger.print(motion_trigger_limit);
+    logger.println(" cm");
   }
 }
 
@@ -1000,25 +1762,27 @@ void Radar_MR24HPC1::run_05_cmd_0x07(bool mode) {
 Sensitivity settings limit response
 Static trigger limit response
 */
-void Radar_MR24HPC1::run_05_cmd_0x08(bool mode) {
-  if (frame[I_DATA] == 0x01) {
+void Radar_MR24HPC1::run_05_cmd_0x08(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  if (f.u8(0) == 0x01) {
     // Level 1
     static_trigger_limit = 250;  // cm
-  } else if (frame[I_DATA] == 0x02) {
+  } else if (f.u8(0) == 0x02) {
     // Level 2
     static_trigger_limit = 300;  // cm
-  } else if (frame[I_DATA] == 0x03) {
+  } else if (f.u8(0) == 0x03) {
     // Level 3
     static_trigger_limit = 400;  // cm
-  } else if (frame[I_DATA] == 0x00) {
+  } else if (f.u8(0) == 0x00) {
     // Level 0
     static_trigger_limit = 0;  // cm
   }
 
   if (mode == VERBAL) {
-    Serial.print("Static trigger limit: ");
-    Serial.print(static_trigger_limit);
-    Serial.println(" cm");
+    logger.print("Static trigger limit: ");
+    logger.print(static_trigger_limit);
+    logger.println(" cm");
   }
 }
 
@@ -1026,12 +1790,15 @@ void Radar_MR24HPC1::run_05_cmd_0x08(bool mode) {
 Custom mode setting response
 0x01 to 0x04
 */
-void Radar_MR24HPC1::run_05_cmd_0x09(bool mode) {
-  custom_mode = frame[I_DATA];
+void Radar_MR24HPC1::run_05_cmd_0x09(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  custom_mode = f.u8(0);
+  shadow.set_mode(custom_mode, true);
 
   if (mode == VERBAL) {
-    Serial.print("Sellected custom mode: ");
-    Serial.println(custom_mode);
+    logger.print("Sellected custom mode: ");
+    logger.println(custom_mode);
   }
 }
 
@@ -1040,14 +1807,14 @@ Initialization status response
 0x01 Completed
 0x02 Incompleted
 */
-void Radar_MR24HPC1::run_05_cmd_0x81(bool mode) {
-  initialization_status = frame[I_DATA];
+void Radar_MR24HPC1::run_05_cmd_0x81(const Radar_Frame &f, bool mode) {
+  initialization_status = f.u8(0);
 
   if (mode == VERBAL) {
     if (initialization_status == 0x01) {
-      Serial.println("Initialization completed.");
+      logger.println("Initialization completed.");
     } else {
-      Serial.println("Initialization incompleted.");
+      logger.println("Initialization incompleted.");
     }
   }
 }
@@ -1056,10 +1823,9 @@ void Radar_MR24HPC1::run_05_cmd_0x81(bool mode) {
 /*
 Motion speed inquiry response
 */
-void Radar_MR24HPC1::run_05_cmd_0x85(bool mode) {
-  uint8_t data = frame[I_DATA];
+void Radar_MR24HPC1::run_05_cmd_0x85(const Radar_Frame &f, bool mode) {
+  uint8_t data = f.u8(0);
   motion_speed = calculate_speed(data);
-  Serial.println(motion_speed);
 
   if (motion_speed < 0) {
     // Negative speed
@@ -1072,9 +1838,9 @@ void Radar_MR24HPC1::run_05_cmd_0x85(bool mode) {
   }
 
   if (mode == VERBAL) {
-    Serial.print("Motion speed: ");
-    Serial.print(motion_speed);
-    Serial.println(" m/s");  // ?
+    logger.print("Motion speed: ");
+    logger.print(motion_speed);
+    logger.println(" m/s");  // ?
   }
 }
 
@@ -1086,27 +1852,29 @@ Scene settings response
 0x03 Bathroom
 0x04 Area detection
 */
-void Radar_MR24HPC1::run_05_cmd_0x87(bool mode) {
-  if (frame[I_DATA] == 0x01) {
+void Radar_MR24HPC1::run_05_cmd_0x87(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  if (f.u8(0) == 0x01) {
     // Living room 4-4.5m
     motion_trigger_limit = 450;  // cm
-  } else if (frame[I_DATA] == 0x02) {
+  } else if (f.u8(0) == 0x02) {
     // Bedroom 4m
     motion_trigger_limit = 400;  // cm
-  } else if (frame[I_DATA] == 0x03) {
+  } else if (f.u8(0) == 0x03) {
     // Bathroom 3m
     motion_trigger_limit = 300;  // cm
-  } else if (frame[I_DATA] == 0x04) {
+  } else if (f.u8(0) == 0x04) {
     // area detection 3.5m
     motion_trigger_limit = 350;  // cm
-  } else if (frame[I_DATA] == 0x00) {
+  } else if (f.u8(0) == 0x00) {
     motion_trigger_limit = 0;
   }
 
   if (mode == VERBAL) {
-    Serial.print("Motion trigger limit: ");
-    Serial.print(motion_trigger_limit);
-    Serial.println(" cm");
+    logger.print("Motion trigger limit: ");
+    logger.print(motion_trigger_limit);
+    logger.println(" cm");
   }
 }
 
@@ -1118,25 +1886,27 @@ Static limit settings response
 0x02 level 2
 0x03 level 3
 */
-void Radar_MR24HPC1::run_05_cmd_0x88(bool mode) {
-  if (frame[I_DATA] == 0x01) {
+void Radar_MR24HPC1::run_05_cmd_0x88(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  if (f.u8(0) == 0x01) {
     // Level 1
     static_trigger_limit = 250;  // cm
-  } else if (frame[I_DATA] == 0x02) {
+  } else if (f.u8(0) == 0x02) {
     // Level 2
     static_trigger_limit = 300;  // cm
-  } else if (frame[I_DATA] == 0x03) {
+  } else if (f.u8(0) == 0x03) {
     // Level 3
     static_trigger_limit = 400;  // cm
-  } else if (frame[I_DATA] == 0x00) {
+  } else if (f.u8(0) == 0x00) {
     // Level 0
     static_trigger_limit = 0;  // cm
   }
 
   if (mode == VERBAL) {
-    Serial.print("Static trigger limit: ");
-    Serial.print(static_trigger_limit);
-    Serial.println(" cm");
+    logger.print("Static trigger limit: ");
+    logger.print(static_trigger_limit);
+    logger.println(" cm");
   }
 }
 
@@ -1144,115 +1914,41 @@ void Radar_MR24HPC1::run_05_cmd_0x88(bool mode) {
 Custom mode inquiry response
 0x01 to 0x04
 */
-void Radar_MR24HPC1::run_05_cmd_0x89(bool mode) {
-  custom_mode = frame[I_DATA];
+void Radar_MR24HPC1::run_05_cmd_0x89(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  custom_mode = f.u8(0);
+  shadow.set_mode(custom_mode, false);
 
   if (mode == VERBAL) {
-    Serial.print("Custom mode: ");
-    Serial.println(custom_mode);
+    logger.print("Custom mode: ");
+    logger.println(custom_mode);
   }
 }
 
 /*
 End of ustom mode setting response
 */
-void Radar_MR24HPC1::run_05_cmd_0x0A(bool mode) {
+void Radar_MR24HPC1::run_05_cmd_0x0A(const Radar_Frame &f, bool mode) {
   if (mode == VERBAL) {
-    Serial.println("Custom mode settings saved!");
+    logger.println("Custom mode settings saved!");
   }
 }
 
 
-/*
-run() helper func
-Controll word 0x08
-*/
-void Radar_MR24HPC1::run_08(bool mode) {
-  int cmd_word = frame[I_CMD_WORD];
-
-  switch (cmd_word) {
-    case 0x00:
-      run_08_cmd_0x00(mode);  // Output switch
-      break;
-    case 0x01:
-      run_08_cmd_0x01(mode);  // Sensor report
-      break;
-    case 0x08:
-      run_08_cmd_0x08(mode);  // Static energy threshold
-      break;
-    case 0x09:
-      run_08_cmd_0x09(mode);  // Motion energy threshold settings
-      break;
-    case 0x80:
-      run_08_cmd_0x80(mode);  // Output switch inquiry
-      break;
-    case 0x81:
-      run_08_cmd_0x81(mode);  // Static energy
-      break;
-    case 0x82:
-      run_08_cmd_0x82(mode);  // Motion energy
-      break;
-    case 0x83:
-      run_08_cmd_0x83(mode);  // Static distance inquiry
-      break;
-    case 0x84:
-      run_08_cmd_0x84(mode);
-      break;
-    case 0x88:
-      run_08_cmd_0x88(mode);  // Static energy threshold
-      break;
-    case 0x89:
-      run_08_cmd_0x89(mode);  // Motion energy threshold
-      break;
-    case 0x0A:
-      run_08_cmd_0x0A(mode);  // Static trigger limit settings
-      break;
-    case 0x8A:
-      run_08_cmd_0x8A(mode);  // Static trigger limit
-      break;
-    case 0x0B:
-      run_08_cmd_0x0B(mode);  // Motion trigger limit settings
-      break;
-     case 0x8B:
-      run_08_cmd_0x8B(mode);  // Motion trigger limit
-      break;
-    case 0x0C:
-      run_08_cmd_0x0C(mode);  // Trigger time setting
-      break;
-    case 0x8C:
-      run_08_cmd_0x8C(mode);  // Motion trigger time
-      break;
-    case 0x0D:
-      run_08_cmd_0x0D(mode);  // Still time setting
-      break;
-    case 0x8D:
-      run_08_cmd_0x8D(mode);  // Motion to still timeg
-      break;
-    case 0x0E:
-      run_08_cmd_0x0E(mode);  // Time for entering no person state
-      break;
-    case 0x8E:
-      run_08_cmd_0x8E(mode);  // Time for entering no person state
-      break;
-    default:
-      // print();
-      break;
-  }
-}
-
 /*
 Advandced mode: ON/OFF
 */
-void Radar_MR24HPC1::run_08_cmd_0x00(bool mode) {
-  if (frame[I_DATA] == 0x01) {
+void Radar_MR24HPC1::run_08_cmd_0x00(const Radar_Frame &f, bool mode) {
+  if (f.u8(0) == 0x01) {
     mode = ADVANCED;
     if (mode == VERBAL) {
-      Serial.println("Advandced mode: ON");
+      logger.println("Advandced mode: ON");
     }
   } else {
     mode = SIMPLE;
     if (mode == VERBAL) {
-      Serial.println("Advandced mode: OFF");
+      logger.println("Advandced mode: OFF");
     }
   }
 }
@@ -1260,13 +1956,13 @@ void Radar_MR24HPC1::run_08_cmd_0x00(bool mode) {
 /*
 Reporting of sensor information
 */
-void Radar_MR24HPC1::run_08_cmd_0x01(bool mode) {
-  static_energy   = frame[I_DATA];
-  static_distance = calculate_distance_cm(frame[I_DATA+1]);
-  motion_energy   = frame[I_DATA+2];
-  motion_distance = calculate_distance_cm(frame[I_DATA+3]);
+void Radar_MR24HPC1::run_08_cmd_0x01(const Radar_Frame &f, bool mode) {
+  static_energy   = f.u8(0);
+  static_distance = calculate_distance_cm(f.u8(1));
+  motion_energy   = f.u8(2);
+  motion_distance = calculate_distance_cm(f.u8(3));
 
-  uint8_t motion_speed_byte = frame[I_DATA+4];
+  uint8_t motion_speed_byte = f.u8(4);
 
   motion_speed = calculate_speed(motion_speed_byte);
 
@@ -1278,40 +1974,83 @@ void Radar_MR24HPC1::run_08_cmd_0x01(bool mode) {
     direction = NONE;
   }
 
+  if (history != nullptr) {
+    history->add_report(millis(), static_energy, static_distance,
+                        motion_energy, motion_distance, motion_speed);
+  }
+
+  if (stats != nullptr) {
+    stats->static_energy.add(static_energy);
+    stats->static_distance.add(static_distance);
+    stats->motion_energy.add(motion_energy);
+    stats->motion_distance.add(motion_distance);
+  }
+
+  uint8_t changed = REPORT_ALL;
+  if (deadband != nullptr) {
+    changed = deadband->update(static_energy, static_distance, motion_energy,
+                               motion_distance, motion_speed, direction);
+    if (changed == 0) {
+      return;  // Nothing to publish
+    }
+  }
+
+  if (sensor_report_callback != nullptr) {
+    Radar_SensorReport report;
+    report.static_energy = static_energy;
+    report.static_distance = static_distance;
+    report.motion_energy = motion_energy;
+    report.motion_distance = motion_distance;
+    report.motion_speed = motion_speed;
+    report.direction = direction;
+    report.changed = changed;
+    sensor_report_callback(this, report);
+  }
+
   if (mode == VERBAL) {
-    Serial.print("Static energy: ");
-    Serial.println(static_energy);  // 0-250
+    if (changed & REPORT_STATIC_ENERGY) {
+      logger.print("Static energy: ");
+      logger.println(static_energy);  // 0-250
+    }
 
-    Serial.print("Static distance: ");
-    Serial.print(static_distance);  // 0-3m
-    Serial.println(" cm");
+    if (changed & REPORT_STATIC_DISTANCE) {
+      logger.print("Static distance: ");
+      logger.print(static_distance);  // 0-3m
+      logger.println(" cm");
+    }
 
-    Serial.print("Motion energy: ");
-    Serial.println(motion_energy);  // 0-250
+    if (changed & REPORT_MOTION_ENERGY) {
+      logger.print("Motion energy: ");
+      logger.println(motion_energy);  // 0-250
+    }
 
-    Serial.print("Motion distance: ");
-    Serial.print(motion_distance);  // 0-4m
-    Serial.println(" cm");
+    if (changed & REPORT_MOTION_DISTANCE) {
+      logger.print("Motion distance: ");
+      logger.print(motion_distance);  // 0-4m
+      logger.println(" cm");
+    }
 
-    Serial.print("Motion speed: ");
-    Serial.print(motion_speed);
-    Serial.println(" m/s");
+    if (changed & REPORT_MOTION_SPEED) {
+      logger.print("Motion speed: ");
+      logger.print(motion_speed);
+      logger.println(" m/s");
+    }
   }
 }
 
 /*
 Advandced mode: ON/OFF
 */
-void Radar_MR24HPC1::run_08_cmd_0x80(bool mode) {
-  if (frame[I_DATA] == 0x01) {
+void Radar_MR24HPC1::run_08_cmd_0x80(const Radar_Frame &f, bool mode) {
+  if (f.u8(0) == 0x01) {
     mode = ADVANCED;
     if (mode == VERBAL) {
-      Serial.println("Advandced mode: ON");
+      logger.println("Advandced mode: ON");
     }
   } else {
     mode = SIMPLE;
     if (mode == VERBAL) {
-      Serial.println("Advandced mode: OFF");
+      logger.println("Advandced mode: OFF");
     }
   }
 }
@@ -1319,237 +2058,224 @@ void Radar_MR24HPC1::run_08_cmd_0x80(bool mode) {
 /*
 Static energy value inquiry
 */
-void Radar_MR24HPC1::run_08_cmd_0x81(bool mode) {
-  static_energy = frame[I_DATA];
+void Radar_MR24HPC1::run_08_cmd_0x81(const Radar_Frame &f, bool mode) {
+  static_energy = f.u8(0);
+
+  if (stats != nullptr) {
+    stats->static_energy.add(static_energy);
+  }
 
   if (mode == VERBAL) {
-    Serial.print("Static energy: ");
-    Serial.println(static_energy);  // 0-250
+    logger.print("Static energy: ");
+    logger.println(static_energy);  // 0-250
   }
 }
 
 /*
 Motion energy value inquiry
 */
-void Radar_MR24HPC1::run_08_cmd_0x82(bool mode) {
-  motion_energy = frame[I_DATA];
+void Radar_MR24HPC1::run_08_cmd_0x82(const Radar_Frame &f, bool mode) {
+  motion_energy = f.u8(0);
+
+  if (stats != nullptr) {
+    stats->motion_energy.add(motion_energy);
+  }
 
   if (mode == VERBAL) {
-    Serial.print("Motion energy: ");
-    Serial.println(motion_energy);  // 0-250
+    logger.print("Motion energy: ");
+    logger.println(motion_energy);  // 0-250
   }
 }
 
 /*
 Static distance inquiry
 */
-void Radar_MR24HPC1::run_08_cmd_0x83(bool mode) {
-  uint8_t data = frame[I_DATA];
+void Radar_MR24HPC1::run_08_cmd_0x83(const Radar_Frame &f, bool mode) {
+  uint8_t data = f.u8(0);
   static_distance = calculate_distance_cm(data);
 
+  if (stats != nullptr) {
+    stats->static_distance.add(static_distance);
+  }
+
   if (mode == VERBAL) {
-    Serial.print("Static distance: ");
-    Serial.print(static_distance);  // 0-3m
-    Serial.println(" cm");
+    logger.print("Static distance: ");
+    logger.print(static_distance);  // 0-3m
+    logger.println(" cm");
   }
 }
 
 /*
 Motion distance inquiry response
 */
-void Radar_MR24HPC1::run_08_cmd_0x84(bool mode) {
-  uint8_t data = frame[I_DATA];
+void Radar_MR24HPC1::run_08_cmd_0x84(const Radar_Frame &f, bool mode) {
+  uint8_t data = f.u8(0);
   motion_distance = calculate_distance_cm(data);
 
+  if (stats != nullptr) {
+    stats->motion_distance.add(motion_distance);
+  }
+
   if (mode == VERBAL) {
-    Serial.print("Motion distance: ");
-    Serial.print(motion_distance);  // 0-4m
-    Serial.println(" cm");
+    logger.print("Motion distance: ");
+    logger.print(motion_distance);  // 0-4m
+    logger.println(" cm");
   }
 }
 
 /*
 Static energy threshold
 */
-void Radar_MR24HPC1::run_08_cmd_0x88(bool mode) {
-  static_energy_threshold = frame[I_DATA];
+void Radar_MR24HPC1::run_08_cmd_0x88(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  static_energy_threshold = f.u8(0);
 
   if (mode == VERBAL) {
-    Serial.print("Static energy threshold: ");
-    Serial.println(static_energy_threshold);  // 0-250
+    logger.print("Static energy threshold: ");
+    logger.println(static_energy_threshold);  // 0-250
   }
 }
 
-void Radar_MR24HPC1::run_08_cmd_0x08(bool mode) {
-  run_08_cmd_0x88(mode);
+void Radar_MR24HPC1::run_08_cmd_0x08(const Radar_Frame &f, bool mode) {
+  run_08_cmd_0x88(f, mode);
 }
 
 /*
 Motion energy threshold
 */
-void Radar_MR24HPC1::run_08_cmd_0x89(bool mode) {
-  motion_energy_threshold = frame[I_DATA];
+void Radar_MR24HPC1::run_08_cmd_0x89(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  motion_energy_threshold = f.u8(0);
 
   if (mode == VERBAL) {
-    Serial.print("Motion energy threshold: ");
-    Serial.println(motion_energy_threshold);  // 0-250
+    logger.print("Motion energy threshold: ");
+    logger.println(motion_energy_threshold);  // 0-250
   }
 }
 
-void Radar_MR24HPC1::run_08_cmd_0x09(bool mode) {
-  run_08_cmd_0x89(mode);
+void Radar_MR24HPC1::run_08_cmd_0x09(const Radar_Frame &f, bool mode) {
+  run_08_cmd_0x89(f, mode);
 }
 
 /*
 Static trigger limit
 */
-void Radar_MR24HPC1::run_08_cmd_0x8A(bool mode) {
-  uint8_t data = frame[I_DATA];
+void Radar_MR24HPC1::run_08_cmd_0x8A(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  uint8_t data = f.u8(0);
   static_trigger_limit = calculate_distance_cm(data);
 
   if (mode == VERBAL) {
-    Serial.print("Static trigger limit: ");
-    Serial.print(static_trigger_limit);  // 0-1000ms
-    Serial.println(" cm");
+    logger.print("Static trigger limit: ");
+    logger.print(static_trigger_limit);  // 0-1000ms
+    logger.println(" cm");
   }
 }
 
-void Radar_MR24HPC1::run_08_cmd_0x0A(bool mode) {
-  run_08_cmd_0x8A(mode);
+void Radar_MR24HPC1::run_08_cmd_0x0A(const Radar_Frame &f, bool mode) {
+  run_08_cmd_0x8A(f, mode);
 }
 
 /*
 Motion trigger limit
 */
-void Radar_MR24HPC1::run_08_cmd_0x8B(bool mode) {
-  uint8_t data = frame[I_DATA];
+void Radar_MR24HPC1::run_08_cmd_0x8B(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  uint8_t data = f.u8(0);
   motion_trigger_limit = calculate_distance_cm(data);
 
   if (mode == VERBAL) {
-    Serial.print("Motion trigger limit: ");
-    Serial.print(motion_trigger_limit);
-    Serial.println(" cm");
+    logger.print("Motion trigger limit: ");
+    logger.print(motion_trigger_limit);
+    logger.println(" cm");
   }
 }
 
-void Radar_MR24HPC1::run_08_cmd_0x0B(bool mode) {
-  run_08_cmd_0x8B(mode);
+void Radar_MR24HPC1::run_08_cmd_0x0B(const Radar_Frame &f, bool mode) {
+  run_08_cmd_0x8B(f, mode);
 }
 
 /*
 Motion trigger time
 */
-void Radar_MR24HPC1::run_08_cmd_0x0C(bool mode) {
-  const unsigned char time_data[4] = {frame[6], frame[7], frame[8], frame[9]};
-  motion_trigger_time = calculate_time(time_data, 4);
+void Radar_MR24HPC1::run_08_cmd_0x0C(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  motion_trigger_time = f.u32(0);
 
   if (mode == VERBAL) {
-    Serial.print("Motion trigger time: ");
-    Serial.print(motion_trigger_time);  // 0-1000ms
-    Serial.println(" ms");
+    logger.print("Motion trigger time: ");
+    logger.print(motion_trigger_time);  // 0-1000ms
+    logger.println(" ms");
   }
 }
 
 /*
 Motion trigger time
 */
-void Radar_MR24HPC1::run_08_cmd_0x8C(bool mode) {
-  const unsigned char time_data[4] = {frame[6], frame[7], frame[8], frame[9]};
-  motion_trigger_time = calculate_time(time_data, 4);
+void Radar_MR24HPC1::run_08_cmd_0x8C(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  motion_trigger_time = f.u32(0);
 
   if (mode == VERBAL) {
-    Serial.print("Motion trigger time: ");
-    Serial.print(motion_trigger_time);  // 0-1000ms
-    Serial.println(" ms");
+    logger.print("Motion trigger time: ");
+    logger.print(motion_trigger_time);  // 0-1000ms
+    logger.println(" ms");
   }
 }
 
 /*
 Motion to still time setting
 */
-void Radar_MR24HPC1::run_08_cmd_0x0D(bool mode) {
-  const unsigned char time_data[4] = {frame[6], frame[7], frame[8], frame[9]};
-  motion_to_static_time = calculate_time(time_data, 4);
+void Radar_MR24HPC1::run_08_cmd_0x0D(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  motion_to_static_time = f.u32(0);
 
   if (mode == VERBAL) {
-    Serial.print("Motion to static time: ");
-    Serial.print(motion_to_static_time);  // 1-60s
-    Serial.println(" ms");
+    logger.print("Motion to static time: ");
+    logger.print(motion_to_static_time);  // 1-60s
+    logger.println(" ms");
   }
 }
 
 /*
 Motion to still time
 */
-void Radar_MR24HPC1::run_08_cmd_0x8D(bool mode) {
-  const unsigned char time_data[4] = {frame[6], frame[7], frame[8], frame[9]};
-  motion_to_static_time = calculate_time(time_data, 4);
+void Radar_MR24HPC1::run_08_cmd_0x8D(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  motion_to_static_time = f.u32(0);
 
   if (mode == VERBAL) {
-    Serial.print("Motion to static time: ");
-    Serial.print(motion_to_static_time);  // 1-60s
-    Serial.println(" ms");
+    logger.print("Motion to static time: ");
+    logger.print(motion_to_static_time);  // 1-60s
+    logger.println(" ms");
   }
 }
 
 /*
 Time for entering no person state
 */
-void Radar_MR24HPC1::run_08_cmd_0x8E(bool mode) {
-  const unsigned char time_data[4] = {frame[6], frame[7], frame[8], frame[9]};
-  time_for_entering_no_person_state = calculate_time(time_data, 4);
+void Radar_MR24HPC1::run_08_cmd_0x8E(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  time_for_entering_no_person_state = f.u32(0);
 
   if (mode == VERBAL) {
-    Serial.print("Time for entering no person state: ");
-    Serial.print(time_for_entering_no_person_state);     // 0s to 3600s
-    Serial.println(" ms");
+    logger.print("Time for entering no person state: ");
+    logger.print(time_for_entering_no_person_state);     // 0s to 3600s
+    logger.println(" ms");
   }
 }
 
-void Radar_MR24HPC1::run_08_cmd_0x0E(bool mode) {
-  run_08_cmd_0x8E(mode);
-}
-
-/*
-Controll word 0x80
-*/
-void Radar_MR24HPC1::run_80(bool mode) {
-  int cmd_word = frame[I_CMD_WORD];
-
-  switch (cmd_word) {
-    case 0x01:  // presence
-      run_80_cmd_0x01(mode);
-      break;
-    case 0x02:  // motion
-      run_80_cmd_0x02(mode);
-      break;
-    case 0x03:  // body parameter
-      run_80_cmd_0x03(mode);
-      break;
-    case 0x81:  // presence
-    run_80_cmd_0x81(mode);
-      break;
-    case 0x82:  // motion
-      run_80_cmd_0x82(mode);
-      break;
-    case 0x83:  // body parameter
-      run_80_cmd_0x83(mode);
-      break;
-    case 0x0A:  // setting time for no person state
-      run_80_cmd_0x0A(mode);
-      break;
-    case 0x0B:  // proximity setting
-      run_80_cmd_0x0B(mode);
-      break;
-    case 0x8A:  // setting time for no person state inquiry
-      run_80_cmd_0x8A(mode);
-      break;
-    case 0x8B:  // proximity inquiry
-      run_80_cmd_0x8B(mode);
-      break;
-    default:
-      break;
-  }
+void Radar_MR24HPC1::run_08_cmd_0x0E(const Radar_Frame &f, bool mode) {
+  run_08_cmd_0x8E(f, mode);
 }
 
 /*
@@ -1557,14 +2283,22 @@ Active reporting of presence information report
 0x00 Unoccupied
 0x01 Occupied
 */
-void Radar_MR24HPC1::run_80_cmd_0x01(bool mode) {
-  presence = frame[I_DATA];
+void Radar_MR24HPC1::run_80_cmd_0x01(const Radar_Frame &f, bool mode) {
+  presence = f.u8(0);
+
+  if (history != nullptr) {
+    history->add_event(millis(), HISTORY_PRESENCE, presence);
+  }
+
+  if (presence_callback != nullptr) {
+    presence_callback(this, presence);
+  }
 
   if (mode == VERBAL) {
     if (presence == OCCUPIED) {
-      Serial.println("Occupied!");
+      logger.println("Occupied!");
     } else if (presence == UNOCCUPIED) {
-      Serial.println("Unoccupied!");
+      logger.println("Unoccupied!");
     }
   }
 }
@@ -1575,19 +2309,27 @@ Active reporting of motion information report
 0x01 Static
 0x02 Active
 */
-void Radar_MR24HPC1::run_80_cmd_0x02(bool mode) {
-  motion = frame[I_DATA];
+void Radar_MR24HPC1::run_80_cmd_0x02(const Radar_Frame &f, bool mode) {
+  motion = f.u8(0);
+
+  if (history != nullptr) {
+    history->add_event(millis(), HISTORY_MOTION, motion);
+  }
+
+  if (motion_callback != nullptr) {
+    motion_callback(this, motion);
+  }
 
   if (mode == VERBAL) {
     switch (motion) {
       case STATIC:
-        Serial.println("Static");
+        logger.println("Static");
         break;
       case ACTIVE:
-        Serial.println("Active");
+        logger.println("Active");
         break;
       default:
-        Serial.println("None");
+        logger.println("None");
         break;
     }
   }
@@ -1597,12 +2339,16 @@ void Radar_MR24HPC1::run_80_cmd_0x02(bool mode) {
 Active reporting of body movement parameter report
 Activity 0-100 body parameter
 */
-void Radar_MR24HPC1::run_80_cmd_0x03(bool mode) {
-  activity = frame[I_DATA];
+void Radar_MR24HPC1::run_80_cmd_0x03(const Radar_Frame &f, bool mode) {
+  activity = f.u8(0);
+
+  if (activity_callback != nullptr) {
+    activity_callback(this, activity);
+  }
 
   if (mode == VERBAL) {
-    Serial.print("Activity: ");
-    Serial.println(activity);
+    logger.print("Activity: ");
+    logger.println(activity);
   }
 }
 
@@ -1611,14 +2357,22 @@ Active reporting of presence information response
 0x00 Unoccupied
 0x01 Occupied
 */
-void Radar_MR24HPC1::run_80_cmd_0x81(bool mode) {
-  presence = frame[I_DATA];
+void Radar_MR24HPC1::run_80_cmd_0x81(const Radar_Frame &f, bool mode) {
+  presence = f.u8(0);
+
+  if (history != nullptr) {
+    history->add_event(millis(), HISTORY_PRESENCE, presence);
+  }
+
+  if (presence_callback != nullptr) {
+    presence_callback(this, presence);
+  }
 
   if (mode == VERBAL) {
     if (presence == OCCUPIED) {
-      Serial.println("Occupied!");
+      logger.println("Occupied!");
     } else if (presence == UNOCCUPIED) {
-      Serial.println("Unoccupied!");
+      logger.println("Unoccupied!");
     }
   }
 }
@@ -1629,19 +2383,27 @@ Active reporting of motion information response
 0x01 Static
 0x02 Active
 */
-void Radar_MR24HPC1::run_80_cmd_0x82(bool mode) {
-  motion = frame[I_DATA];
+void Radar_MR24HPC1::run_80_cmd_0x82(const Radar_Frame &f, bool mode) {
+  motion = f.u8(0);
+
+  if (history != nullptr) {
+    history->add_event(millis(), HISTORY_MOTION, motion);
+  }
+
+  if (motion_callback != nullptr) {
+    motion_callback(this, motion);
+  }
 
   if (mode == VERBAL) {
     switch (motion) {
       case STATIC:
-        Serial.println("Static");
+        logger.println("Static");
         break;
       case ACTIVE:
-        Serial.println("Active");
+        logger.println("Active");
         break;
       default:
-        Serial.println("None");
+        logger.println("None");
         break;
     }
   }
@@ -1652,20 +2414,26 @@ Body movement parameter inquiry report
 Actifity - Body parameter
 0-100%
 */
-void Radar_MR24HPC1::run_80_cmd_0x83(bool mode) {
-  activity = frame[I_DATA];
+void Radar_MR24HPC1::run_80_cmd_0x83(const Radar_Frame &f, bool mode) {
+  activity = f.u8(0);
+
+  if (activity_callback != nullptr) {
+    activity_callback(this, activity);
+  }
 
   if (mode == VERBAL) {
-    Serial.print("Activity: ");
-    Serial.println(activity);
+    logger.print("Activity: ");
+    logger.println(activity);
   }
 }
 
 /*
 Time for entering no person state setting response
 */
-void Radar_MR24HPC1::run_80_cmd_0x0A(bool mode) {
-  uint8_t time_byte = frame[I_DATA];
+void Radar_MR24HPC1::run_80_cmd_0x0A(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  uint8_t time_byte = f.u8(0);
 
   switch (time_byte) {
     case 0x00:
@@ -1700,9 +2468,9 @@ void Radar_MR24HPC1::run_80_cmd_0x0A(bool mode) {
   }
 
   if (mode == VERBAL) {
-    Serial.print("Time for entering no person state: ");
-    Serial.print(time_for_entering_no_person_state);     // 0s to 30min
-    Serial.println(" ms");
+    logger.print("Time for entering no person state: ");
+    logger.print(time_for_entering_no_person_state);     // 0s to 30min
+    logger.println(" ms");
   }
 }
 
@@ -1712,14 +2480,18 @@ Active reporting of proximity response
 0x01 APPROACHING
 0x02 RECEDING
 */
-void Radar_MR24HPC1::run_80_cmd_0x0B(bool mode) {
-  direction = frame[I_DATA];
+void Radar_MR24HPC1::run_80_cmd_0x0B(const Radar_Frame &f, bool mode) {
+  direction = f.u8(0);
+
+  if (direction_callback != nullptr) {
+    direction_callback(this, direction);
+  }
 
   if (mode == VERBAL) {
     if (direction == APPROACHING) {
-      Serial.println("Approaching");
+      logger.println("Approaching");
     } else if (direction == RECEDING) {
-      Serial.println("Receding");
+      logger.println("Receding");
     }
   }
 }
@@ -1727,8 +2499,10 @@ void Radar_MR24HPC1::run_80_cmd_0x0B(bool mode) {
 /*
 Time for entering no person state inquiry response
 */
-void Radar_MR24HPC1::run_80_cmd_0x8A(bool mode) {
-  uint8_t time_byte = frame[I_DATA];
+void Radar_MR24HPC1::run_80_cmd_0x8A(const Radar_Frame &f, bool mode) {
+  update_setting(f, mode);
+
+  uint8_t time_byte = f.u8(0);
 
   switch (time_byte) {
     case 0x00:
@@ -1763,9 +2537,9 @@ void Radar_MR24HPC1::run_80_cmd_0x8A(bool mode) {
   }
 
   if (mode == VERBAL) {
-    Serial.print("Time for entering no person state: ");
-    Serial.print(time_for_entering_no_person_state);     // 0s to 30min
-    Serial.println(" ms");
+    logger.print("Time for entering no person state: ");
+    logger.print(time_for_entering_no_person_state);     // 0s to 30min
+    logger.println(" ms");
   }
 }
 
@@ -1775,19 +2549,79 @@ Proximity inquiry response
 0x01 APPROACHING
 0x02 RECEDING
 */
-void Radar_MR24HPC1::run_80_cmd_0x8B(bool mode) {
-  direction = frame[I_DATA];
+void Radar_MR24HPC1::run_80_cmd_0x8B(const Radar_Frame &f, bool mode) {
+  direction = f.u8(0);
+
+  if (direction_callback != nullptr) {
+    direction_callback(this, direction);
+  }
 
   if (mode == VERBAL) {
     if (direction == APPROACHING) {
-      Serial.println("Approaching");
+      logger.println("Approaching");
     } else if (direction == RECEDING) {
-      Serial.println("Receding");
+      logger.println("Receding");
     }
   }
 }
 
 
+/*
+Callbacks are called from run() as soon as frame is processed.
+nullptr removes callback.
+*/
+void Radar_MR24HPC1::on_presence(Radar_ValueCallback cb) {
+  presence_callback = cb;
+}
+
+void Radar_MR24HPC1::on_motion(Radar_ValueCallback cb) {
+  motion_callback = cb;
+}
+
+void Radar_MR24HPC1::on_activity(Radar_ValueCallback cb) {
+  activity_callback = cb;
+}
+
+void Radar_MR24HPC1::on_direction(Radar_ValueCallback cb) {
+  direction_callback = cb;
+}
+
+void Radar_MR24HPC1::on_heartbeat(Radar_ValueCallback cb) {
+  heartbeat_callback = cb;
+}
+
+void Radar_MR24HPC1::on_sensor_report(Radar_ReportCallback cb) {
+  sensor_report_callback = cb;
+}
+
+void Radar_MR24HPC1::on_config_divergence(Radar_DivergenceCallback cb) {
+  divergence_callback = cb;
+}
+
+/*
+Last setting value confirmed by radar, raw value of setting frame
+Returns false if radar has not told it yet
+*/
+bool Radar_MR24HPC1::get_setting(uint8_t control_word, uint8_t cmd_word,
+                                 uint32_t &value) {
+  return shadow.get(control_word, cmd_word, value);
+}
+
+/*
+How many times radar told other setting value than was set or known
+*/
+uint32_t Radar_MR24HPC1::get_config_divergences() {
+  return shadow.get_divergences();
+}
+
+/*
+Forget confirmed settings, next setters are sent even if value is same
+*/
+void Radar_MR24HPC1::forget_config() {
+  shadow.clear();
+}
+
+
 /*
 Returns radar mode:
 1 - Advandced
@@ -1955,3 +2789,85 @@ int Radar_MR24HPC1::get_static_trigger_limit() {
   ask_static_limit();
   return static_trigger_limit;
 }
+
+
+/*
+Transaction: many settings in one custom mode session
+Starts custom mode and collects setting frames to one batch.
+Inside caller's batch the frames go out with it.
+custom_mode - 1 to 4, with 0 transaction is not open and sends nothing
+*/
+Radar_Transaction::Radar_Transaction(Radar_MR24HPC1 *r, uint8_t custom_mode)
+  : radar(r), open(custom_mode != 0) {
+    if (!open) {
+      return;
+    }
+    radar->begin_batch();
+    radar->in_transaction = true;
+    radar->transaction_started = false;  // Started by first change
+    // Same limit as start_custom_mode_settings(), shadow compares modes
+    radar->transaction_mode = custom_mode > 0x04 ? 0x04 : custom_mode;
+}
+
+/*
+Commits if commit() was not called
+*/
+Radar_Transaction::~Radar_Transaction() {
+  if (open) {
+    commit();
+  }
+}
+
+/*
+Setters do nothing after commit() or if custom mode was invalid
+*/
+void Radar_Transaction::set_motion_limit(uint8_t limit) {
+  if (open) {
+    radar->set_motion_limit(limit);
+  }
+}
+
+void Radar_Transaction::set_static_limit(uint8_t limit) {
+  if (open) {
+    radar->set_static_limit(limit);
+  }
+}
+
+void Radar_Transaction::set_static_threshold(uint8_t limit) {
+  if (open) {
+    radar->set_static_threshold(limit);
+  }
+}
+
+void Radar_Transaction::set_motion_threshold(uint8_t limit) {
+  if (open) {
+    radar->set_motion_threshold(limit);
+  }
+}
+
+void Radar_Transaction::set_absence_trigger_time(uint32_t time_ms) {
+  if (open) {
+    radar->set_absence_trigger_time(time_ms);
+  }
+}
+
+/*
+Save all settings with one end of custom mode frame
+Returns request, done when radar confirms settings are saved (0x05 0x0A).
+Invalid request if radar already had all values and nothing was sent.
+*/
+Radar_Request Radar_Transaction::commit() {
+  if (!open) {
+    return Radar_Request();
+  }
+
+  open = false;
+  radar->in_transaction = false;
+
+  Radar_Request saved;
+  if (radar->transaction_started) {
+    saved = radar->end_custom_mode_settings();
+  }
+  radar->end_batch();
+  return saved;
+}
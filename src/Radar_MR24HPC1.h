@@ -5,6 +5,20 @@ Copyright 2023 Tauno Erik
 #ifndef LIB_RADAR_MR24HPC1_SRC_RADAR_MR24HPC1_H_
 #define LIB_RADAR_MR24HPC1_SRC_RADAR_MR24HPC1_H_
 
+#if !defined(ARDUINO)
+#include "host/Radar_host.h"  // Linux gateways
+#endif
+#include "Radar_frame.h"
+#include "Radar_ring.h"
+#include "Radar_snapshot.h"
+#include "Radar_history.h"
+#include "Radar_stats.h"
+#include "Radar_deadband.h"
+#include "Radar_capture.h"
+#include "Radar_counters.h"
+#include "Radar_log.h"
+#include "Radar_shadow.h"
+
 // Frame Headers
 #define HEAD1          0x53  // Frame header 1
 #define HEAD2          0x59  // Frame header 2
@@ -63,23 +77,196 @@ Copyright 2023 Tauno Erik
 #define ADVANCED       1
 //
 #define FRAME_SIZE    32  // Max data frame size in bytes. Is it 128??
+#define FRAME_OVERHEAD 9  // Frame size without data bytes
+#ifndef REQUEST_SLOTS
+#define REQUEST_SLOTS  4  // Queries waiting for response
+#endif
+#define REQUEST_TIMEOUT_MS 500  // Default response deadline
+
+// Request status
+#define REQUEST_NONE     0
+#define REQUEST_PENDING  1
+#define REQUEST_DONE     2
+#define REQUEST_TIMEOUT  3
+#define REQUEST_ERROR    4
+#ifndef TX_BUFFER_SIZE
+#define TX_BUFFER_SIZE 64  // Batch of queries sent with one write
+#endif
+#ifndef FRAME_QUEUE_SIZE
+#define FRAME_QUEUE_SIZE 4  // Received frames waiting for run()
+#endif
+
+#define INFO_TEXT_SIZE (FRAME_SIZE - FRAME_OVERHEAD + 1)  // Product info + '\0'
+
+// Product info fields received
+#define INFO_PRODUCT_MODEL     0x01
+#define INFO_PRODUCT_ID        0x02
+#define INFO_HARDWARE_MODEL    0x04
+#define INFO_FIRMWARE_VERSION  0x08
+#define INFO_ALL               0x0F
+
+#define QUERY_SIZE    10  // Query frame with 1 data byte
+#define QUERY4_SIZE   13  // Query frame with 4 data bytes
+
+// Query frame with 1 data byte
+struct Radar_Query {
+  uint8_t bytes[QUERY_SIZE];
+};
+
+// Setting frame with 4 data bytes
+struct Radar_Query4 {
+  uint8_t bytes[QUERY4_SIZE];
+};
+
+/*
+Query frame builder, works at compile time
+data - 0x0F for inquiries
+*/
+constexpr Radar_Query radar_query(uint8_t control_word, uint8_t cmd_word,
+                                  uint8_t data = 0x0F) {
+  return Radar_Query{{
+    HEAD1, HEAD2, control_word, cmd_word, 0x00, 0x01, data,
+    static_cast<uint8_t>(HEAD1 + HEAD2 + control_word + cmd_word + 0x01 + data),
+    END1, END2}};
+}
+
+/*
+Setting frame builder, value is sent big-endian
+*/
+constexpr Radar_Query4 radar_query4(uint8_t control_word, uint8_t cmd_word,
+                                    uint32_t value) {
+  return Radar_Query4{{
+    HEAD1, HEAD2, control_word, cmd_word, 0x00, 0x04,
+    static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16),
+    static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value),
+    static_cast<uint8_t>(HEAD1 + HEAD2 + control_word + cmd_word + 0x04
+      + static_cast<uint8_t>(value >> 24) + static_cast<uint8_t>(value >> 16)
+      + static_cast<uint8_t>(value >> 8) + static_cast<uint8_t>(value)),
+    END1, END2}};
+}
+
+class Radar_MR24HPC1;
+
+// ADVANCED mode sensor report
+struct Radar_SensorReport {
+  int   static_energy;    // 0-250
+  int   static_distance;  // cm
+  int   motion_energy;    // 0-250
+  int   motion_distance;  // cm
+  float motion_speed;     // m/s
+  int   direction;        // APPROACHING, RECEDING or NONE
+  uint8_t changed;        // REPORT_* bits, see set_deadband()
+};
+
+// Product information, control word 0x02
+struct Radar_DeviceInfo {
+  char product_model[INFO_TEXT_SIZE];
+  char product_id[INFO_TEXT_SIZE];
+  char hardware_model[INFO_TEXT_SIZE];
+  char firmware_version[INFO_TEXT_SIZE];
+  uint8_t received;  // INFO_* bits
+};
+
+// Handle of query sent to radar
+struct Radar_Request {
+  uint8_t slot;
+  uint8_t id;  // 0 is invalid request
+
+  Radar_Request(uint8_t s = 0, uint8_t i = 0) : slot(s), id(i) {}
+};
+
+typedef void (*Radar_ValueCallback)(Radar_MR24HPC1 *radar, int value);
+typedef void (*Radar_ReportCallback)(Radar_MR24HPC1 *radar,
+                                     const Radar_SensorReport &report);
+typedef void (*Radar_DivergenceCallback)(Radar_MR24HPC1 *radar,
+                                         uint8_t control_word, uint8_t cmd_word,
+                                         uint32_t expected, uint32_t actual);
 
 class Radar_MR24HPC1 {
  private:
     Stream *stream;     // SoftwareSerial or Serial1
-    unsigned char frame[FRAME_SIZE] = {0};
-    bool is_new_frame;  // New frame is ready
-    uint8_t frame_len;  // Data frame size
+    Radar_RxRing *rx_ring = nullptr;  // Optional interrupt fed input
+    Radar_Snapshot *snapshot = nullptr;  // Optional state for other threads
+    Radar_History *history = nullptr;    // Optional report history
+    Radar_Stats *stats = nullptr;        // Optional running statistics
+    Radar_Deadband *deadband = nullptr;  // Optional change-only reports
+    Radar_Recorder *recorder = nullptr;  // Optional capture of all frames
+    Radar_Counters *counters = nullptr;  // Optional parser counters
+    Radar_Log logger;                    // VERBAL text of handlers
+    Radar_DeviceInfo info = {};          // Product info responses
+    // Received frames queue
+    unsigned char frames[FRAME_QUEUE_SIZE][FRAME_SIZE] = {{0}};
+    uint8_t frames_len[FRAME_QUEUE_SIZE] = {0};
+    uint8_t frames_head = 0;   // Oldest frame
+    uint8_t frames_count = 0;  // Frames in queue
+    uint8_t rx_len = 0;        // Bytes of incoming frame received
+    uint16_t rx_expected = 0;  // Incoming frame size from length bytes
+    // Bytes of broken frame after its first byte, parsed again
+    uint8_t replay[FRAME_SIZE] = {0};
+    uint8_t replay_len = 0;
+    uint8_t replay_pos = 0;
+    // Lost bytes
+    uint32_t rx_skipped = 0;   // Since last good frame
+    uint32_t last_discarded = 0;
+
+    bool parse_byte(uint8_t byte);  // Frame parser
+    bool parse_replay();            // Parse replay bytes first
+    void process(bool mode, uint8_t max_frames, bool from_stream);
+    void resync(const unsigned char *rx, uint8_t len);  // Broken frame
+    bool next_frame(Radar_Frame &f);  // Take frame from queue
+    void read_ring();               // Read from rx_ring
 
     float calculate_distance_m(int val);
     int   calculate_distance_cm(int data);
     float calculate_speed(int val);
-    int   calculate_time(const unsigned char hex[], int size);
 
-    void send_query(const unsigned char *frame, int len);  // Send to radar
+    Radar_Request send_query(const unsigned char *frame, int len);  // Send to radar
+    Radar_Request send_query_P(const Radar_Query *query);  // From flash
+    uint8_t absence_time_code(uint32_t time_ms);
+
+    // Outgoing batch
+    uint8_t tx_buffer[TX_BUFFER_SIZE] = {0};
+    uint8_t tx_len = 0;
+    uint8_t batch_depth = 0;  // Nested begin_batch() calls
+    bool flush_each = true;  // flush() after every query
+
+    void write_batch();
+
+    // Custom mode session around setters
+    friend class Radar_Transaction;
+    bool in_transaction = false;
+    bool transaction_started = false;  // Custom mode start was sent
+    uint8_t transaction_mode = 1;
+
+    void begin_setting();
+    void end_setting();
+
+    // Settings confirmed by radar
+    Radar_Shadow shadow;
+
+    void send_setting(uint8_t control_word, uint8_t cmd_word, uint32_t value,
+                      bool wide = false);  // Skipped if radar has value
+    void update_setting(const Radar_Frame &f, bool mode);  // From response
+
+    // Sent queries waiting for response
+    struct Pending {
+      uint8_t control_word;
+      uint8_t cmd_word;
+      uint8_t id;
+      uint8_t status = REQUEST_NONE;
+      unsigned long sent;  // millis()
+      uint16_t timeout;    // ms
+    };
+    Pending requests[REQUEST_SLOTS];
+    uint8_t request_id = 0;
+    uint8_t requests_pending = 0;
+    uint16_t request_timeout = REQUEST_TIMEOUT_MS;
+
+    Radar_Request add_request(uint8_t control_word, uint8_t cmd_word);
+    void complete_request(uint8_t control_word, uint8_t cmd_word);
     // Calculate checksum
     uint8_t calculate_sum(const unsigned char f[], int size);
-    uint8_t get_frame_sum(uint8_t *frame, int len);
+    uint16_t get_data_len(const unsigned char f[]);
     bool is_frame_good(const unsigned char f[]);
 
     int hex_to_int(const unsigned char *hexChar);
@@ -87,54 +274,75 @@ class Radar_MR24HPC1 {
     void print_hex(const unsigned char *buff, int len);
     void print_dec(const unsigned char *buff, int len);
 
+    // Frame handlers table
+    typedef void (Radar_MR24HPC1::*Handler)(const Radar_Frame &f, bool mode);
+    struct Route {
+      uint8_t control_word;
+      uint8_t cmd_word;
+      Handler handler;
+    };
+    friend struct Radar_Routes;
+    void dispatch(const Radar_Frame &f, bool mode);  // Call frame handler
+
     // Responses
-    void run_01(bool mode = NONVERBAL);  // Heartbeat
-    void run_02(bool mode = NONVERBAL);
-    void run_05(bool mode = NONVERBAL);
-    void run_05_cmd_0x01(bool mode = NONVERBAL);  // Init completed
-    void run_05_cmd_0x07(bool mode = NONVERBAL);  // Motion limit respomse
-    void run_05_cmd_0x08(bool mode = NONVERBAL);  // Static limit response
-    void run_05_cmd_0x09(bool mode = NONVERBAL);  // Custom mode setting
-    void run_05_cmd_0x81(bool mode = NONVERBAL);  // Initialization status inquiry response
-    // void run_05_cmd_0x84(bool mode = NONVERBAL);  // TODO: tegelikult 08_0x84 Motion distance response
-    void run_05_cmd_0x85(bool mode = NONVERBAL);  // Motion speed response
-    void run_05_cmd_0x87(bool mode = NONVERBAL);  // Scene settings
-    void run_05_cmd_0x88(bool mode = NONVERBAL);  // Sensitivity settings
-    void run_05_cmd_0x89(bool mode = NONVERBAL);  // Custom mode inquiry response
-    void run_05_cmd_0x0A(bool mode = NONVERBAL);  // End of custom mode setting
-    void run_08(bool mode = NONVERBAL);
-    void run_08_cmd_0x00(bool mode = NONVERBAL);  // advandced on/off
-    void run_08_cmd_0x01(bool mode = NONVERBAL);  // Sensor report
-    void run_08_cmd_0x08(bool mode = NONVERBAL);  // Static energy threshold
-    void run_08_cmd_0x09(bool mode = NONVERBAL);  // Motion energy threshold
-    void run_08_cmd_0x80(bool mode = NONVERBAL);  // advandced on/off
-    void run_08_cmd_0x81(bool mode = NONVERBAL);  // Static energy
-    void run_08_cmd_0x82(bool mode = NONVERBAL);  // Motion energy
-    void run_08_cmd_0x83(bool mode = NONVERBAL);  // Static distance
-    void run_08_cmd_0x84(bool mode = NONVERBAL);  // Motion distance
-    void run_08_cmd_0x88(bool mode = NONVERBAL);  // Static energy threshold
-    void run_08_cmd_0x89(bool mode = NONVERBAL);  // Motion energy threshold
-    void run_08_cmd_0x0A(bool mode = NONVERBAL);  // Static trigger limit
-    void run_08_cmd_0x8A(bool mode = NONVERBAL);  // Static trigger limit
-    void run_08_cmd_0x0B(bool mode = NONVERBAL);  // Motion trigger limit
-    void run_08_cmd_0x8B(bool mode = NONVERBAL);  // Motion trigger limit
-    void run_08_cmd_0x0C(bool mode = NONVERBAL);  // Motion trigger time setting
-    void run_08_cmd_0x8C(bool mode = NONVERBAL);  // Motion trigger time
-    void run_08_cmd_0x0D(bool mode = NONVERBAL);  // Motion to still time setting
-    void run_08_cmd_0x8D(bool mode = NONVERBAL);  // Motion to still time
-    void run_08_cmd_0x0E(bool mode = NONVERBAL);  // entering no person state
-    void run_08_cmd_0x8E(bool mode = NONVERBAL);  // entering no person state
-    void run_80(bool mode = NONVERBAL);
-    void run_80_cmd_0x01(bool mode = NONVERBAL);  // Presence report
-    void run_80_cmd_0x02(bool mode = NONVERBAL);  // Motion report
-    void run_80_cmd_0x03(bool mode = NONVERBAL);  // Body parameter report
-    void run_80_cmd_0x81(bool mode = NONVERBAL);  // Presence response
-    void run_80_cmd_0x82(bool mode = NONVERBAL);  // Motion response
-    void run_80_cmd_0x83(bool mode = NONVERBAL);  // Body parameter
-    void run_80_cmd_0x0A(bool mode = NONVERBAL);  // setting time for no person state
-    void run_80_cmd_0x0B(bool mode = NONVERBAL);  // proximity setting
-    void run_80_cmd_0x8A(bool mode = NONVERBAL);  // setting time for no person state inquiry
-    void run_80_cmd_0x8B(bool mode = NONVERBAL);  // proximity inquiry
+    void run_01_cmd_0x01(const Radar_Frame &f, bool mode);  // Heartbeat
+    void run_01_cmd_0x02(const Radar_Frame &f, bool mode);  // Reset
+    void run_02_cmd_0xA1(const Radar_Frame &f, bool mode);  // Product model
+    void run_02_cmd_0xA2(const Radar_Frame &f, bool mode);  // Product ID
+    void run_02_cmd_0xA3(const Radar_Frame &f, bool mode);  // Hardware model
+    void run_02_cmd_0xA4(const Radar_Frame &f, bool mode);  // Firmware version
+    void run_03(const Radar_Frame &f, bool mode);           // UART upgrade
+    void run_05_cmd_0x01(const Radar_Frame &f, bool mode);  // Init completed
+    void run_05_cmd_0x07(const Radar_Frame &f, bool mode);  // Motion limit respomse
+    void run_05_cmd_0x08(const Radar_Frame &f, bool mode);  // Static limit response
+    void run_05_cmd_0x09(const Radar_Frame &f, bool mode);  // Custom mode setting
+    void run_05_cmd_0x81(const Radar_Frame &f, bool mode);  // Initialization status inquiry response
+    // void run_05_cmd_0x84(const Radar_Frame &f, bool mode);  // TODO: tegelikult 08_0x84 Motion distance response
+    void run_05_cmd_0x85(const Radar_Frame &f, bool mode);  // Motion speed response
+    void run_05_cmd_0x87(const Radar_Frame &f, bool mode);  // Scene settings
+    void run_05_cmd_0x88(const Radar_Frame &f, bool mode);  // Sensitivity settings
+    void run_05_cmd_0x89(const Radar_Frame &f, bool mode);  // Custom mode inquiry response
+    void run_05_cmd_0x0A(const Radar_Frame &f, bool mode);  // End of custom mode setting
+    void run_08_cmd_0x00(const Radar_Frame &f, bool mode);  // advandced on/off
+    void run_08_cmd_0x01(const Radar_Frame &f, bool mode);  // Sensor report
+    void run_08_cmd_0x08(const Radar_Frame &f, bool mode);  // Static energy threshold
+    void run_08_cmd_0x09(const Radar_Frame &f, bool mode);  // Motion energy threshold
+    void run_08_cmd_0x80(const Radar_Frame &f, bool mode);  // advandced on/off
+    void run_08_cmd_0x81(const Radar_Frame &f, bool mode);  // Static energy
+    void run_08_cmd_0x82(const Radar_Frame &f, bool mode);  // Motion energy
+    void run_08_cmd_0x83(const Radar_Frame &f, bool mode);  // Static distance
+    void run_08_cmd_0x84(const Radar_Frame &f, bool mode);  // Motion distance
+    void run_08_cmd_0x88(const Radar_Frame &f, bool mode);  // Static energy threshold
+    void run_08_cmd_0x89(const Radar_Frame &f, bool mode);  // Motion energy threshold
+    void run_08_cmd_0x0A(const Radar_Frame &f, bool mode);  // Static trigger limit
+    void run_08_cmd_0x8A(const Radar_Frame &f, bool mode);  // Static trigger limit
+    void run_08_cmd_0x0B(const Radar_Frame &f, bool mode);  // Motion trigger limit
+    void run_08_cmd_0x8B(const Radar_Frame &f, bool mode);  // Motion trigger limit
+    void run_08_cmd_0x0C(const Radar_Frame &f, bool mode);  // Motion trigger time setting
+    void run_08_cmd_0x8C(const Radar_Frame &f, bool mode);  // Motion trigger time
+    void run_08_cmd_0x0D(const Radar_Frame &f, bool mode);  // Motion to still time setting
+    void run_08_cmd_0x8D(const Radar_Frame &f, bool mode);  // Motion to still time
+    void run_08_cmd_0x0E(const Radar_Frame &f, bool mode);  // entering no person state
+    void run_08_cmd_0x8E(const Radar_Frame &f, bool mode);  // entering no person state
+    void run_80_cmd_0x01(const Radar_Frame &f, bool mode);  // Presence report
+    void run_80_cmd_0x02(const Radar_Frame &f, bool mode);  // Motion report
+    void run_80_cmd_0x03(const Radar_Frame &f, bool mode);  // Body parameter report
+    void run_80_cmd_0x81(const Radar_Frame &f, bool mode);  // Presence response
+    void run_80_cmd_0x82(const Radar_Frame &f, bool mode);  // Motion response
+    void run_80_cmd_0x83(const Radar_Frame &f, bool mode);  // Body parameter
+    void run_80_cmd_0x0A(const Radar_Frame &f, bool mode);  // setting time for no person state
+    void run_80_cmd_0x0B(const Radar_Frame &f, bool mode);  // proximity setting
+    void run_80_cmd_0x8A(const Radar_Frame &f, bool mode);  // setting time for no person state inquiry
+    void run_80_cmd_0x8B(const Radar_Frame &f, bool mode);  // proximity inquiry
+
+    // Event callbacks
+    Radar_ValueCallback presence_callback = nullptr;
+    Radar_ValueCallback motion_callback = nullptr;
+    Radar_ValueCallback activity_callback = nullptr;
+    Radar_ValueCallback direction_callback = nullptr;
+    Radar_ValueCallback heartbeat_callback = nullptr;
+    Radar_ReportCallback sensor_report_callback = nullptr;
+    Radar_DivergenceCallback divergence_callback = nullptr;
 
     // Radar dada
     int mode = ADVANCED;  // 0 simple, 1 advanced
@@ -171,56 +379,108 @@ class Radar_MR24HPC1 {
     Radar_MR24HPC1(Stream *s);
 
     void set_mode(int mode);          // Simple or Advanced
-    void ask_mode();
+    Radar_Request ask_mode();
 
-    void read();                      // Read dada frame
+    void read();                      // Read dada frame, non-blocking
+    size_t feed(const uint8_t *data, size_t len);  // Parse given bytes
+    void set_rx_ring(Radar_RxRing *ring);          // Read from byte ring
     void print(int mode = HEX);       // Print frame
-
-    void run(bool mode = NONVERBAL);  // process frames
+    void set_snapshot(Radar_Snapshot *s);  // Publish state after frames
+    void get_state(Radar_State &state);    // All values at once
+    void set_history(Radar_History *h);    // Keep timed reports
+    void set_stats(Radar_Stats *s);        // Energy and distance statistics
+    void set_deadband(Radar_Deadband *d);  // Only changed sensor reports
+    void set_recorder(Radar_Recorder *r);  // Capture sent and received frames
+    void set_counters(Radar_Counters *c);  // Parser and dispatch counters
+    void set_log_output(Print *p);         // VERBAL text, RADAR_LOG_BUFFERED
+    void set_log_callback(Radar_LogCallback cb);  // RADAR_LOG_CALLBACK
+    uint32_t get_log_dropped();            // Frames of text not sent
+
+    void run(bool mode = NONVERBAL, uint8_t max_frames = 0);  // process frames
+    void run_fed(bool mode = NONVERBAL, uint8_t max_frames = 0);  // no read()
 
     void reset();                     // x
-    void ask_heartbeat();             // x
-    void ask_product_model();
-    void ask_product_id();
-    void ask_hardware_model();
-    void ask_firmware_version();
+    Radar_Request ask_heartbeat();             // x
+    Radar_Request ask_product_model();
+    Radar_Request ask_product_id();
+    Radar_Request ask_hardware_model();
+    Radar_Request ask_firmware_version();
+    Radar_Request ask_device_info();  // All product info not yet received
 
-    void ask_initialization_status();  // x
-    void ask_custom_mode();
+    Radar_Request ask_initialization_status();  // x
+    Radar_Request ask_custom_mode();
 
-    void ask_presence();               // x Occupation
+    Radar_Request ask_presence();              // x Occupation
 
-    void ask_activity();               // x
-    void ask_absence_trigger_time();   // x
-    void ask_direction();              // x APPROACHING RECEDING
+    Radar_Request ask_activity();              // x
+    Radar_Request ask_absence_trigger_time();  // x
+    Radar_Request ask_direction();             // x APPROACHING RECEDING
 
-    void ask_motion_energy();          // x
-    void ask_motion_body_distance();   // x
-    void ask_motion_limit();           // x advanced and simple
-    void ask_motion_speed();           // x
+    Radar_Request ask_motion_energy();         // x
+    Radar_Request ask_motion_body_distance();  // x
+    Radar_Request ask_motion_limit();          // x advanced and simple
+    Radar_Request ask_motion_speed();          // x
 
-    void ask_motion();                 // x none, static, active
-    void ask_motion_trigger_time();    // x
-    void ask_motion_to_static_time();  // x
-    void ask_no_person_time();         // x
+    Radar_Request ask_motion();                // x none, static, active
+    Radar_Request ask_motion_trigger_time();   // x
+    Radar_Request ask_motion_to_static_time();  // x
+    Radar_Request ask_no_person_time();        // x
 
-    void ask_static_energy();          // x
-    void ask_static_body_distance();   // x
-    void ask_static_limit();           // x
+    Radar_Request ask_static_energy();         // x
+    Radar_Request ask_static_body_distance();  // x
+    Radar_Request ask_static_limit();          // x
 
     void set_motion_limit(uint8_t limit);      // x  simple + advanced
     void set_static_limit(uint8_t limit);      // x simple + advanced
     void set_static_threshold(uint8_t limit);  //
     void set_motion_threshold(uint8_t limit);  // 0-250
 
-    void set_absence_trigger_time(int time_ms);  // simple
-
-    void start_custom_mode_settings(uint8_t mode);
-    void end_custom_mode_settings();
+    void set_absence_trigger_time(uint32_t time_ms);  // simple + advanced
+
+    Radar_Request start_custom_mode_settings(uint8_t mode);
+    Radar_Request end_custom_mode_settings();
+
+    // Send many queries with one write
+    void begin_batch();
+    void end_batch(bool flush = false);
+    void set_flush(bool flush);  // flush after every query
+
+    // Query responses
+    uint8_t get_request_status(Radar_Request req);
+    bool wait(Radar_Request req, bool mode = NONVERBAL);  // until response
+    void set_request_timeout(uint16_t timeout_ms);
+    void update_requests();     // Time out requests without response
+    long time_to_deadline();    // ms until a request times out, -1 none
+
+    // Events, called from run()
+    void on_presence(Radar_ValueCallback cb);        // UNOCCUPIED, OCCUPIED
+    void on_motion(Radar_ValueCallback cb);          // NONE, STATIC, ACTIVE
+    void on_activity(Radar_ValueCallback cb);        // 0-100
+    void on_direction(Radar_ValueCallback cb);       // APPROACHING, RECEDING
+    void on_heartbeat(Radar_ValueCallback cb);       // heartbeat counter
+    void on_sensor_report(Radar_ReportCallback cb);  // ADVANCED mode report
+    void on_config_divergence(Radar_DivergenceCallback cb);  // Setting differs
+
+    // Settings confirmed by radar
+    bool get_setting(uint8_t control_word, uint8_t cmd_word, uint32_t &value);
+    uint32_t get_config_divergences();  // times radar value was unexpected
+    void forget_config();               // next setters are sent again
 
 // ----------------------//
     int get_mode();                  // return radar mode
     int get_heartbeat();             // returns heartbeat counter value
+    uint32_t get_unknown_frames();   // frames without handler
+    uint32_t get_resyncs();          // times bytes were lost
+    uint32_t get_discarded_bytes();  // all lost bytes
+    uint32_t get_last_discarded();   // bytes lost in last resync
+
+    // Product info, "" until response is received
+    const char *get_product_model();
+    const char *get_product_id();
+    const char *get_hardware_model();
+    const char *get_firmware_version();
+    bool has_device_info();          // all four received
+    const Radar_DeviceInfo &get_device_info();
 
     // Works only in SIMPLE mode:
     int get_motion();
@@ -241,4 +501,30 @@ class Radar_MR24HPC1 {
 
 };
 
+/*
+Many settings with one custom mode start and save
+  Radar_Transaction tx(&radar);
+  tx.set_motion_limit(RANGE_300_CM);
+  tx.set_static_limit(RANGE_250_CM);
+  radar.wait(tx.commit());
+*/
+class Radar_Transaction {
+ private:
+    Radar_MR24HPC1 *radar;
+    bool open;  // Not committed yet, false if custom mode was invalid
+
+ public:
+    explicit Radar_Transaction(Radar_MR24HPC1 *r, uint8_t custom_mode = 1);
+    ~Radar_Transaction();
+
+    void set_motion_limit(uint8_t limit);
+    void set_static_limit(uint8_t limit);
+    void set_static_threshold(uint8_t limit);
+    void set_motion_threshold(uint8_t limit);
+    void set_absence_trigger_time(uint32_t time_ms);
+
+    Radar_Request commit();  // Save settings, if any was sent
+    bool is_open() const { return open; }
+};
+
 #endif  // LIB_RADAR_MR24HPC1_SRC_RADAR_MR24HPC1_H_
@@ -0,0 +1,154 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_RADAR_CAPTURE_H_
+#define LIB_RADAR_MR24HPC1_SRC_RADAR_CAPTURE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+Capture file format, all numbers little-endian:
+
+File header, 8 bytes
+  0  'R' 'C' 'A' 'P'
+  4  version (1)
+  5  record header size (6)
+  6  reserved, 0 0
+Records, one after another, file is only appended
+  0  frame size in bytes
+  1  flags: CAPTURE_TX, CAPTURE_BAD, CAPTURE_RAW
+  2  time, micros(), 32 bits, wraps after 71 minutes
+  6  frame bytes, from 0x53 0x59 to 0x54 0x43,
+     or received bytes as they came in a RAW record
+
+Records have no padding, so a reader can walk an mmap()-ed file
+from start to end with record header size + frame size steps.
+*/
+#define CAPTURE_VERSION        1
+#define CAPTURE_HEADER_SIZE    8
+#define CAPTURE_RECORD_HEADER  6
+
+// Record flags
+#define CAPTURE_RX   0x00  // Received from radar
+#define CAPTURE_TX   0x01  // Sent to radar
+#define CAPTURE_BAD  0x02  // Checksum or tail was wrong
+#define CAPTURE_RAW  0x04  // Received bytes, not split to frames
+
+/*
+Writes received and sent frames to a Print: SD card file,
+Serial or Radar_FilePrint on Linux.
+Radar_MR24HPC1 calls record(), see set_recorder().
+Frame capture has the frames parser found, raw capture has
+received bytes as they came, so replay also repeats lost
+bytes and checksum errors.
+*/
+class Radar_Recorder {
+ private:
+    Print *out = nullptr;
+    uint32_t records = 0;
+    uint32_t lost = 0;  // Records not fully written
+    bool raw = false;
+    bool failed = false;  // Short write, file has part of a record
+
+ public:
+    /*
+    Start capture, writes file header
+    append - out is an existing capture, no header
+    */
+    bool begin(Print *p, bool append = false) {
+      out = p;
+      records = 0;
+      lost = 0;
+      failed = false;
+
+      if (append) {
+        return true;
+      }
+
+      const uint8_t header[CAPTURE_HEADER_SIZE] = {
+        'R', 'C', 'A', 'P', CAPTURE_VERSION, CAPTURE_RECORD_HEADER, 0, 0};
+      return out->write(header, sizeof(header)) == sizeof(header);
+    }
+
+    void end() {
+      if (out != nullptr) {
+        out->flush();
+      }
+      out = nullptr;
+    }
+
+    /*
+    Add one frame
+    Record that does not fit availableForWrite() is skipped whole.
+    After a short write later records would not line up, so
+    recording stops and they are only counted as lost.
+    */
+    void record(const uint8_t *frame, uint8_t len, uint8_t flags) {
+      if (out == nullptr) {
+        return;
+      }
+
+      size_t size = CAPTURE_RECORD_HEADER + len;
+      int room = out->availableForWrite();  // 0 if output can't tell
+      if (failed || (room > 0 && static_cast<size_t>(room) < size)) {
+        lost++;
+        return;
+      }
+
+      uint32_t time = micros();
+      uint8_t header[CAPTURE_RECORD_HEADER] = {
+        len, flags,
+        static_cast<uint8_t>(time), static_cast<uint8_t>(time >> 8),
+        static_cast<uint8_t>(time >> 16), static_cast<uint8_t>(time >> 24)};
+
+      size_t written = out->write(header, sizeof(header));
+      if (written == sizeof(header)) {
+        written += out->write(frame, len);
+      }
+
+      if (written == size) {
+        records++;
+      } else {
+        lost++;
+        failed = true;
+      }
+    }
+
+    /*
+    Raw capture: received bytes, not frames, sent queries are the same
+    */
+    void set_raw(bool r) { raw = r; }
+    bool is_raw() const { return raw; }
+
+    /*
+    Add frame found by parser, only in frame capture
+    */
+    void record_frame(const uint8_t *frame, uint8_t len, uint8_t flags) {
+      if (!raw) {
+        record(frame, len, flags);
+      }
+    }
+
+    /*
+    Add received bytes, only in raw capture
+    */
+    void record_bytes(const uint8_t *data, size_t len) {
+      if (!raw) {
+        return;
+      }
+      while (len > 0) {
+        uint8_t n = len > 255 ? 255 : static_cast<uint8_t>(len);
+        record(data, n, CAPTURE_RX | CAPTURE_RAW);
+        data += n;
+        len -= n;
+      }
+    }
+
+    uint32_t get_records() const { return records; }
+    uint32_t get_lost() const { return lost; }
+    bool is_failed() const { return failed; }  // Stopped by short write
+};
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_RADAR_CAPTURE_H_
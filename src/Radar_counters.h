@@ -0,0 +1,198 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_RADAR_COUNTERS_H_
+#define LIB_RADAR_MR24HPC1_SRC_RADAR_COUNTERS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef COUNTER_COMMANDS
+#define COUNTER_COMMANDS 64  // Histogram slots, one per handled command
+#endif
+
+/*
+Receive and dispatch counters of one radar.
+Radar_MR24HPC1 is the only writer, see set_counters().
+Other threads read single counters without locks. On AVR,
+if run() is called from an interrupt, read with interrupts off.
+reset() only asks for reset, the writer clears all counters
+before its next update, so a reset never races with a write.*/
+class Radar_Counters {
+ private:
+    uint32_t bytes = 0;            // Bytes read from stream or fed
+    uint32_t frames = 0;           // Good frames
+    uint32_t checksum_errors = 0;  // Tail was right, checksum wrong
+    uint32_t truncated = 0;        // Bad tail or impossible length
+    uint32_t resyncs = 0;          // Bytes were lost before a good frame
+    uint32_t discarded = 0;        // Bytes not part of a good frame
+    uint32_t unknown = 0;          // Frames without handler
+    uint8_t unknown_control_word = 0;  // Last frame without handler
+    uint8_t unknown_cmd_word = 0;
+
+    // Frames per handler, slot is route number
+    uint32_t commands[COUNTER_COMMANDS] = {0};
+    uint8_t control_words[COUNTER_COMMANDS] = {0};
+    uint8_t cmd_words[COUNTER_COMMANDS] = {0};
+
+    // run() calls that processed frames
+    uint32_t runs = 0;
+    uint32_t run_total = 0;  // us, wraps after 71 minutes of run()
+    uint32_t run_min = 0;
+    uint32_t run_max = 0;
+
+    bool reset_pending = false;
+
+    static_assert(COUNTER_COMMANDS <= 255, "COUNTER_COMMANDS max is 255");
+
+#if defined(__AVR__)
+    static uint32_t load(const uint32_t &c) { return c; }
+    static void store(uint32_t &c, uint32_t v) { c = v; }
+#else
+    static uint32_t load(const uint32_t &c) {
+      return __atomic_load_n(&c, __ATOMIC_RELAXED);
+    }
+    static void store(uint32_t &c, uint32_t v) {
+      __atomic_store_n(&c, v, __ATOMIC_RELAXED);
+    }
+#endif
+
+    static void add(uint32_t &c, uint32_t n) { store(c, c + n); }
+
+    void apply_reset() {
+      if (!__atomic_load_n(&reset_pending, __ATOMIC_ACQUIRE)) {
+        return;
+      }
+      store(bytes, 0);
+      store(frames, 0);
+      store(checksum_errors, 0);
+      store(truncated, 0);
+      store(resyncs, 0);
+      store(discarded, 0);
+      store(unknown, 0);
+      unknown_control_word = 0;
+      unknown_cmd_word = 0;
+      for (uint8_t i = 0; i < COUNTER_COMMANDS; i++) {
+        store(commands[i], 0);
+        control_words[i] = 0;
+        cmd_words[i] = 0;
+      }
+      store(runs, 0);
+      store(run_total, 0);
+      store(run_min, 0);
+      store(run_max, 0);
+      __atomic_store_n(&reset_pending, false, __ATOMIC_RELEASE);
+    }
+
+ public:
+    // Writer side, called by Radar_MR24HPC1
+    void add_bytes(uint32_t n) {
+      apply_reset();
+      add(bytes, n);
+    }
+
+    void add_frame() {
+      apply_reset();
+      add(frames, 1);
+    }
+
+    void add_checksum_error() {
+      apply_reset();
+      add(checksum_errors, 1);
+    }
+
+    void add_truncated() {
+      apply_reset();
+      add(truncated, 1);
+    }
+
+    void add_command(uint8_t route, uint8_t control_word, uint8_t cmd_word) {
+      apply_reset();
+      if (route < COUNTER_COMMANDS) {
+        control_words[route] = control_word;
+        cmd_words[route] = cmd_word;
+        add(commands[route], 1);
+      }
+    }
+
+    void add_resync(uint32_t lost) {
+      apply_reset();
+      add(resyncs, 1);
+      add(discarded, lost);
+    }
+
+    void add_unknown(uint8_t control_word, uint8_t cmd_word) {
+      apply_reset();
+      unknown_control_word = control_word;
+      unknown_cmd_word = cmd_word;
+      add(unknown, 1);
+    }
+
+    void add_run(uint32_t us) {
+      apply_reset();
+      if (runs == 0 || us < run_min) {
+        store(run_min, us);
+      }
+      if (us > run_max) {
+        store(run_max, us);
+      }
+      add(run_total, us);
+      add(runs, 1);
+    }
+
+    // Reader side, any thread
+    void reset() { __atomic_store_n(&reset_pending, true, __ATOMIC_RELEASE); }
+
+    uint32_t get_bytes() const { return load(bytes); }
+    uint32_t get_frames() const { return load(frames); }
+    uint32_t get_checksum_errors() const { return load(checksum_errors); }
+    uint32_t get_truncated() const { return load(truncated); }
+    uint32_t get_resyncs() const { return load(resyncs); }
+    uint32_t get_discarded() const { return load(discarded); }
+    uint32_t get_unknown() const { return load(unknown); }
+
+    // Pair of last frame without handler, 0 0 if none
+    void get_last_unknown(uint8_t &control_word, uint8_t &cmd_word) const {
+      control_word = unknown_control_word;
+      cmd_word = unknown_cmd_word;
+    }
+
+    /*
+    Histogram slot i, 0 to COUNTER_COMMANDS - 1
+    Returns frames, control_word and cmd_word are set if frames > 0
+    */
+    uint32_t get_command(uint8_t i, uint8_t &control_word,
+                         uint8_t &cmd_word) const {
+      if (i >= COUNTER_COMMANDS) {
+        return 0;
+      }
+      uint32_t count = load(commands[i]);
+      control_word = control_words[i];
+      cmd_word = cmd_words[i];
+      return count;
+    }
+
+    // Frames of one control and command word pair
+    uint32_t get_command_frames(uint8_t control_word, uint8_t cmd_word) const {
+      for (uint8_t i = 0; i < COUNTER_COMMANDS; i++) {
+        uint8_t cw, cmd;
+        uint32_t count = get_command(i, cw, cmd);
+        if (count > 0 && cw == control_word && cmd == cmd_word) {
+          return count;
+        }
+      }
+      return 0;
+    }
+
+    uint32_t get_runs() const { return load(runs); }
+    uint32_t get_run_min() const { return load(run_min); }  // us
+    uint32_t get_run_max() const { return load(run_max); }  // us
+
+    uint32_t get_run_avg() const {  // us
+      uint32_t n = load(runs);
+      return n > 0 ? load(run_total) / n : 0;
+    }
+};
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_RADAR_COUNTERS_H_
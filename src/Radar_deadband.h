@@ -0,0 +1,143 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_RADAR_DEADBAND_H_
+#define LIB_RADAR_MR24HPC1_SRC_RADAR_DEADBAND_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef DEADBAND_ENERGY
+#define DEADBAND_ENERGY    5     // Default, energy units
+#endif
+#ifndef DEADBAND_DISTANCE
+#define DEADBAND_DISTANCE  50    // Default, cm, one distance step
+#endif
+#ifndef DEADBAND_SPEED
+#define DEADBAND_SPEED     0.5f  // Default, m/s, one speed step
+#endif
+
+// Changed fields of sensor report
+#define REPORT_STATIC_ENERGY    0x01
+#define REPORT_STATIC_DISTANCE  0x02
+#define REPORT_MOTION_ENERGY    0x04
+#define REPORT_MOTION_DISTANCE  0x08
+#define REPORT_MOTION_SPEED     0x10
+#define REPORT_DIRECTION        0x20
+#define REPORT_ALL              0x3F
+
+/*
+Change-only filter of ADVANCED mode sensor reports.
+A field is changed when it differs from the last published value
+by at least its deadband, 0 means any change. Small drift is
+compared with the published value, not the previous report,
+so it is published when it adds up.
+Radar_MR24HPC1::run() uses it, see set_deadband().
+*/
+class Radar_Deadband {
+ private:
+    int static_energy_band = DEADBAND_ENERGY;
+    int static_distance_band = DEADBAND_DISTANCE;
+    int motion_energy_band = DEADBAND_ENERGY;
+    int motion_distance_band = DEADBAND_DISTANCE;
+    float motion_speed_band = DEADBAND_SPEED;
+
+    // Last published values
+    int static_energy = 0;
+    int static_distance = 0;
+    int motion_energy = 0;
+    int motion_distance = 0;
+    float motion_speed = 0;
+    int direction = 0;
+    bool published = false;  // false until first report
+
+    uint32_t reports = 0;
+    uint32_t suppressed = 0;
+
+    static bool is_changed(int last, int value, int band) {
+      int diff = value > last ? value - last : last - value;
+      return diff != 0 && diff >= band;
+    }
+
+    static bool is_changed(float last, float value, float band) {
+      float diff = value > last ? value - last : last - value;
+      return diff != 0 && diff >= band;
+    }
+
+ public:
+    void set_energy(int band) {
+      static_energy_band = band;
+      motion_energy_band = band;
+    }
+
+    void set_distance(int band) {
+      static_distance_band = band;
+      motion_distance_band = band;
+    }
+
+    void set_speed(float band) { motion_speed_band = band; }
+
+    void set_static(int energy_band, int distance_band) {
+      static_energy_band = energy_band;
+      static_distance_band = distance_band;
+    }
+
+    void set_motion(int energy_band, int distance_band) {
+      motion_energy_band = energy_band;
+      motion_distance_band = distance_band;
+    }
+
+    /*
+    Compare report with last published values
+    Returns REPORT_* bits of changed fields, 0 if report is suppressed.
+    Changed fields become the new published values.
+    */
+    uint8_t update(int se, int sd, int me, int md, float speed, int dir) {
+      reports++;
+
+      uint8_t changed = 0;
+      if (!published) {
+        changed = REPORT_ALL;
+        published = true;
+      } else {
+        if (is_changed(static_energy, se, static_energy_band)) {
+          changed |= REPORT_STATIC_ENERGY;
+        }
+        if (is_changed(static_distance, sd, static_distance_band)) {
+          changed |= REPORT_STATIC_DISTANCE;
+        }
+        if (is_changed(motion_energy, me, motion_energy_band)) {
+          changed |= REPORT_MOTION_ENERGY;
+        }
+        if (is_changed(motion_distance, md, motion_distance_band)) {
+          changed |= REPORT_MOTION_DISTANCE;
+        }
+        if (is_changed(motion_speed, speed, motion_speed_band)) {
+          changed |= REPORT_MOTION_SPEED;
+        }
+        if (dir != direction) {
+          changed |= REPORT_DIRECTION;
+        }
+      }
+
+      if (changed & REPORT_STATIC_ENERGY) static_energy = se;
+      if (changed & REPORT_STATIC_DISTANCE) static_distance = sd;
+      if (changed & REPORT_MOTION_ENERGY) motion_energy = me;
+      if (changed & REPORT_MOTION_DISTANCE) motion_distance = md;
+      if (changed & REPORT_MOTION_SPEED) motion_speed = speed;
+      if (changed & REPORT_DIRECTION) direction = dir;
+
+      if (changed == 0) {
+        suppressed++;
+      }
+      return changed;
+    }
+
+    void reset() { published = false; }  // Next report is published whole
+
+    uint32_t get_reports() const { return reports; }
+    uint32_t get_suppressed() const { return suppressed; }
+};
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_RADAR_DEADBAND_H_
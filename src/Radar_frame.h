@@ -0,0 +1,50 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_RADAR_FRAME_H_
+#define LIB_RADAR_MR24HPC1_SRC_RADAR_FRAME_H_
+
+#include <stdint.h>
+
+/*
+Read-only view of one received frame in the frames queue
+Nothing is copied. Data bytes are read with big-endian accessors,
+index 0 is the first data byte. Reads outside data return 0.
+*/
+class Radar_Frame {
+ private:
+    const uint8_t *bytes;  // Whole frame, starts with HEAD1
+    uint8_t len;           // Whole frame size
+
+ public:
+    Radar_Frame(const uint8_t *b = nullptr, uint8_t n = 0)
+      : bytes(b), len(n) {}
+
+    const uint8_t *raw() const { return bytes; }
+    uint8_t size() const { return len; }
+
+    uint8_t control_word() const { return len > 2 ? bytes[2] : 0; }
+    uint8_t cmd_word() const { return len > 3 ? bytes[3] : 0; }
+
+    // Number of data bytes
+    uint16_t data_len() const {
+      return len > 5 ? (static_cast<uint16_t>(bytes[4]) << 8) | bytes[5] : 0;
+    }
+
+    const uint8_t *data() const { return bytes + 6; }
+
+    uint8_t u8(uint8_t i) const {
+      return i < data_len() ? bytes[6 + i] : 0;
+    }
+
+    uint16_t u16(uint8_t i) const {
+      return (static_cast<uint16_t>(u8(i)) << 8) | u8(i + 1);
+    }
+
+    uint32_t u32(uint8_t i) const {
+      return (static_cast<uint32_t>(u16(i)) << 16) | u16(i + 2);
+    }
+};
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_RADAR_FRAME_H_
@@ -0,0 +1,192 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_RADAR_HISTORY_H_
+#define LIB_RADAR_MR24HPC1_SRC_RADAR_HISTORY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef HISTORY_REPORTS
+#define HISTORY_REPORTS 32  // 0x08 0x01 sensor reports kept, max 255
+#endif
+#ifndef HISTORY_EVENTS
+#define HISTORY_EVENTS  16  // 0x80 presence and motion events kept, max 255
+#endif
+
+// History fields
+#define HISTORY_STATIC_ENERGY    0
+#define HISTORY_STATIC_DISTANCE  1  // cm
+#define HISTORY_MOTION_ENERGY    2
+#define HISTORY_MOTION_DISTANCE  3  // cm
+#define HISTORY_MOTION_SPEED     4  // m/s
+#define HISTORY_PRESENCE         5  // UNOCCUPIED, OCCUPIED
+#define HISTORY_MOTION           6  // NONE, STATIC, ACTIVE
+
+// Sensor report
+struct Radar_HistoryReport {
+  uint32_t time;             // millis()
+  uint16_t static_distance;  // cm
+  uint16_t motion_distance;  // cm
+  uint8_t  static_energy;    // 0-250
+  uint8_t  motion_energy;    // 0-250
+  int8_t   motion_speed;     // 0.5 m/s steps
+};
+
+// Presence or motion report or inquiry response
+struct Radar_HistoryEvent {
+  uint32_t time;   // millis()
+  uint8_t  field;  // HISTORY_PRESENCE or HISTORY_MOTION
+  uint8_t  value;
+};
+
+// Result of window query
+struct Radar_HistoryStats {
+  uint16_t count;
+  float    min;
+  float    max;
+  float    mean;
+};
+
+/*
+Last sensor reports and events with their time, in fixed memory.
+Oldest entry is overwritten when full. Adding is O(1),
+window queries read only entries inside the window.
+Radar_MR24HPC1::run() adds to it, see set_history().
+*/
+class Radar_History {
+ private:
+    Radar_HistoryReport reports[HISTORY_REPORTS];
+    Radar_HistoryEvent events[HISTORY_EVENTS];
+    uint8_t reports_head = 0;  // Next write
+    uint8_t reports_count = 0;
+    uint8_t events_head = 0;
+    uint8_t events_count = 0;
+
+    static_assert(HISTORY_REPORTS <= 255, "HISTORY_REPORTS max is 255");
+    static_assert(HISTORY_EVENTS <= 255, "HISTORY_EVENTS max is 255");
+
+    static float report_value(const Radar_HistoryReport &r, uint8_t field) {
+      switch (field) {
+        case HISTORY_STATIC_ENERGY:
+          return r.static_energy;
+        case HISTORY_STATIC_DISTANCE:
+          return r.static_distance;
+        case HISTORY_MOTION_ENERGY:
+          return r.motion_energy;
+        case HISTORY_MOTION_DISTANCE:
+          return r.motion_distance;
+        default:
+          return r.motion_speed * 0.5f;
+      }
+    }
+
+    static void add_value(Radar_HistoryStats &stats, float value,
+                          float *sum) {
+      if (stats.count == 0 || value < stats.min) {
+        stats.min = value;
+      }
+      if (stats.count == 0 || value > stats.max) {
+        stats.max = value;
+      }
+      *sum += value;
+      stats.count++;
+    }
+
+ public:
+    /*
+    Add 0x08 0x01 sensor report
+    speed - m/s
+    */
+    void add_report(uint32_t time, int static_energy, int static_distance,
+                    int motion_energy, int motion_distance, float speed) {
+      Radar_HistoryReport &r = reports[reports_head];
+      r.time = time;
+      r.static_energy = static_energy;
+      r.static_distance = static_distance;
+      r.motion_energy = motion_energy;
+      r.motion_distance = motion_distance;
+      r.motion_speed = static_cast<int8_t>(speed * 2
+                                           + (speed < 0 ? -0.5f : 0.5f));
+
+      reports_head = (reports_head + 1) % HISTORY_REPORTS;
+      if (reports_count < HISTORY_REPORTS) {
+        reports_count++;
+      }
+    }
+
+    /*
+    Add 0x80 presence or motion report (0x01 0x02) or response (0x81 0x82)
+    field - HISTORY_PRESENCE or HISTORY_MOTION
+    */
+    void add_event(uint32_t time, uint8_t field, uint8_t value) {
+      Radar_HistoryEvent &e = events[events_head];
+      e.time = time;
+      e.field = field;
+      e.value = value;
+
+      events_head = (events_head + 1) % HISTORY_EVENTS;
+      if (events_count < HISTORY_EVENTS) {
+        events_count++;
+      }
+    }
+
+    uint8_t get_reports_count() const { return reports_count; }
+    uint8_t get_events_count() const { return events_count; }
+
+    /*
+    Report by age, 0 is newest
+    */
+    const Radar_HistoryReport &get_report(uint8_t age) const {
+      return reports[(reports_head + HISTORY_REPORTS - 1 - age)
+                     % HISTORY_REPORTS];
+    }
+
+    const Radar_HistoryEvent &get_event(uint8_t age) const {
+      return events[(events_head + HISTORY_EVENTS - 1 - age) % HISTORY_EVENTS];
+    }
+
+    /*
+    Min, max and mean of field over last window_ms before now
+    now - usually millis()
+    Returns number of values, stats are not set if 0
+    */
+    uint16_t get_stats(uint8_t field, uint32_t window_ms, uint32_t now,
+                       Radar_HistoryStats &stats) const {
+      float sum = 0;
+      stats.count = 0;
+
+      if (field <= HISTORY_MOTION_SPEED) {
+        for (uint8_t age = 0; age < reports_count; age++) {
+          const Radar_HistoryReport &r = get_report(age);
+          if (now - r.time > window_ms) {
+            break;  // Older are outside too
+          }
+          add_value(stats, report_value(r, field), &sum);
+        }
+      } else {
+        for (uint8_t age = 0; age < events_count; age++) {
+          const Radar_HistoryEvent &e = get_event(age);
+          if (now - e.time > window_ms) {
+            break;
+          }
+          if (e.field == field) {
+            add_value(stats, e.value, &sum);
+          }
+        }
+      }
+
+      if (stats.count > 0) {
+        stats.mean = sum / stats.count;
+      }
+      return stats.count;
+    }
+
+    void clear() {
+      reports_count = 0;
+      events_count = 0;
+    }
+};
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_RADAR_HISTORY_H_
@@ -0,0 +1,214 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_RADAR_LOG_H_
+#define LIB_RADAR_MR24HPC1_SRC_RADAR_LOG_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+VERBAL mode output of frame handlers, selected at compile time
+with -DRADAR_LOG=...
+RADAR_LOG_NONE      - no logging code at all, VERBAL does nothing
+RADAR_LOG_BUFFERED  - text of one frame is one write to a Print,
+                      sent only as fast as Print takes it, never blocks
+RADAR_LOG_CALLBACK  - text of one frame is given to a function
+*/
+#define RADAR_LOG_NONE      0
+#define RADAR_LOG_BUFFERED  1
+#define RADAR_LOG_CALLBACK  2
+
+#ifndef RADAR_LOG
+#define RADAR_LOG RADAR_LOG_BUFFERED
+#endif
+
+// Smaller on AVR, Uno has 2 KB RAM for all radars
+#ifndef LOG_BUFFER_SIZE
+#if defined(__AVR__)
+#define LOG_BUFFER_SIZE 64
+#else
+#define LOG_BUFFER_SIZE 128  // BUFFERED: text waiting for Print, max 255
+#endif
+#endif
+#ifndef LOG_LINE_SIZE
+#if defined(__AVR__)
+#define LOG_LINE_SIZE   64
+#else
+#define LOG_LINE_SIZE   128  // CALLBACK: text of one frame, max 255
+#endif
+#endif
+#ifndef LOG_DIRECT_WRITE
+#define LOG_DIRECT_WRITE 16  // BUFFERED: bytes per pump() when Print tells 0
+#endif
+
+class Radar_MR24HPC1;
+
+typedef void (*Radar_LogCallback)(Radar_MR24HPC1 *radar,
+                                  const char *text, size_t len);
+
+#if RADAR_LOG == RADAR_LOG_NONE
+
+/*
+Takes print calls and compiles to nothing
+*/
+class Radar_Log {
+ public:
+    template <typename T>
+    size_t print(T, int = 0) { return 0; }
+    template <typename T>
+    size_t println(T, int = 0) { return 0; }
+    size_t println() { return 0; }
+
+    void set_output(Print *) {}
+    void set_callback(Radar_LogCallback) {}
+    void commit(Radar_MR24HPC1 *) {}
+    void pump() {}
+    uint32_t get_dropped() const { return 0; }
+};
+
+#else
+
+/*
+Collects handler text of one frame, commit() sends it whole or
+drops it whole if there is no room.
+*/
+class Radar_Log : public Print {
+ private:
+    uint32_t dropped = 0;  // Frames of text not sent
+    bool overflow = false;
+
+#if RADAR_LOG == RADAR_LOG_BUFFERED
+    Print *out = &Serial;
+    bool out_room = false;  // out has told availableForWrite() > 0
+    uint8_t buffer[LOG_BUFFER_SIZE];
+    uint8_t head = 0;    // Next byte to send
+    uint8_t count = 0;   // Committed bytes
+    uint8_t staged = 0;  // Bytes of current frame
+
+    static_assert(LOG_BUFFER_SIZE <= 255, "LOG_BUFFER_SIZE max is 255");
+#else
+    Radar_LogCallback callback = nullptr;
+    char line[LOG_LINE_SIZE];
+    uint8_t len = 0;
+
+    static_assert(LOG_LINE_SIZE <= 255, "LOG_LINE_SIZE max is 255");
+#endif
+
+ public:
+    size_t write(uint8_t byte) override {
+#if RADAR_LOG == RADAR_LOG_BUFFERED
+      if (count + staged >= LOG_BUFFER_SIZE) {
+        overflow = true;
+        return 0;
+      }
+      buffer[(head + count + staged) % LOG_BUFFER_SIZE] = byte;
+      staged++;
+#else
+      if (len >= LOG_LINE_SIZE) {
+        overflow = true;
+        return 0;
+      }
+      line[len++] = static_cast<char>(byte);
+#endif
+      return 1;
+    }
+    using Print::write;
+
+    /*
+    Output of BUFFERED log
+    p - Print, nullptr drops all text
+    Print that has never told availableForWrite() > 0 (SoftwareSerial,
+    File) gets LOG_DIRECT_WRITE bytes per pump(), that write may wait.
+    */
+    void set_output(Print *p) {
+#if RADAR_LOG == RADAR_LOG_BUFFERED
+      out = p;
+      out_room = false;
+#else
+      (void)p;
+#endif
+    }
+
+    /*
+    Function of CALLBACK log
+    */
+    void set_callback(Radar_LogCallback cb) {
+#if RADAR_LOG == RADAR_LOG_CALLBACK
+      callback = cb;
+#else
+      (void)cb;
+#endif
+    }
+
+    /*
+    End of frame, send its text
+    */
+    void commit(Radar_MR24HPC1 *radar) {
+#if RADAR_LOG == RADAR_LOG_BUFFERED
+      (void)radar;
+      if (staged == 0 && !overflow) {
+        return;
+      }
+      if (overflow || out == nullptr) {
+        dropped++;
+      } else {
+        count += staged;
+      }
+      staged = 0;
+      overflow = false;
+      pump();
+#else
+      if (len == 0 && !overflow) {
+        return;
+      }
+      if (overflow || callback == nullptr) {
+        dropped++;
+      } else {
+        callback(radar, line, len);
+      }
+      len = 0;
+      overflow = false;
+#endif
+    }
+
+    /*
+    Send as much committed text as output takes without waiting
+    */
+    void pump() {
+#if RADAR_LOG == RADAR_LOG_BUFFERED
+      bool direct = false;
+      while (count > 0 && out != nullptr) {
+        int room = out->availableForWrite();
+        if (room > 0) {
+          out_room = true;
+        } else if (out_room || direct) {
+          return;  // Full
+        } else {
+          room = LOG_DIRECT_WRITE;  // Print without availableForWrite()
+          direct = true;
+        }
+        uint8_t n = LOG_BUFFER_SIZE - head;  // Until end of buffer
+        if (n > count) {
+          n = count;
+        }
+        if (n > room) {
+          n = room;
+        }
+        n = out->write(&buffer[head], n);
+        if (n == 0) {
+          return;
+        }
+        head = (head + n) % LOG_BUFFER_SIZE;
+        count -= n;
+      }
+#endif
+    }
+
+    uint32_t get_dropped() const { return dropped; }
+};
+
+#endif  // RADAR_LOG
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_RADAR_LOG_H_
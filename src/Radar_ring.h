@@ -0,0 +1,105 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_RADAR_RING_H_
+#define LIB_RADAR_MR24HPC1_SRC_RADAR_RING_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef RX_RING_SIZE
+#define RX_RING_SIZE 64  // Bytes, power of two, max 128
+#endif
+
+/*
+Single producer, single consumer lock-free byte ring.
+Producer is UART RX interrupt or a reader thread: push()
+Consumer is Radar_MR24HPC1::read(): peek() and consume()
+Indexes are single bytes, so loads and stores are atomic on 8-bit MCUs too.
+*/
+class Radar_RxRing {
+ private:
+    uint8_t buffer[RX_RING_SIZE] = {0};
+    uint8_t head = 0;      // Next write, changed only by producer
+    uint8_t tail = 0;      // Next read, changed only by consumer
+    uint16_t dropped = 0;  // Bytes lost because ring was full
+
+    static_assert((RX_RING_SIZE & (RX_RING_SIZE - 1)) == 0,
+                  "RX_RING_SIZE must be power of two");
+    static_assert(RX_RING_SIZE <= 128, "RX_RING_SIZE max is 128");
+
+ public:
+    /*
+    Producer: add one byte
+    Returns false if ring is full and byte is dropped
+    */
+    bool push(uint8_t byte) {
+      uint8_t h = head;
+      uint8_t t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+
+      if (static_cast<uint8_t>(h - t) == RX_RING_SIZE) {
+        dropped++;
+        return false;
+      }
+
+      buffer[h & (RX_RING_SIZE - 1)] = byte;
+      __atomic_store_n(&head, static_cast<uint8_t>(h + 1), __ATOMIC_RELEASE);
+      return true;
+    }
+
+    /*
+    Producer: add many bytes
+    Returns how many bytes were added
+    */
+    size_t push(const uint8_t *data, size_t len) {
+      size_t count = 0;
+
+      while (count < len && push(data[count])) {
+        count++;
+      }
+
+      return count;
+    }
+
+    /*
+    Consumer: bytes waiting in ring
+    */
+    size_t available() const {
+      uint8_t h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+      return static_cast<uint8_t>(h - tail);
+    }
+
+    /*
+    Consumer: pointer to the oldest bytes without copying
+    Returns number of contiguous bytes at data
+    */
+    size_t peek(const uint8_t **data) const {
+      size_t count = available();
+      size_t start = tail & (RX_RING_SIZE - 1);
+
+      if (start + count > RX_RING_SIZE) {
+        count = RX_RING_SIZE - start;  // Until the end of buffer
+      }
+
+      *data = &buffer[start];
+      return count;
+    }
+
+    /*
+    Consumer: free len bytes returned by peek()
+    */
+    void consume(size_t len) {
+      __atomic_store_n(&tail, static_cast<uint8_t>(tail + len),
+                       __ATOMIC_RELEASE);
+    }
+
+    /*
+    Bytes lost because consumer was too slow
+    */
+    uint16_t get_dropped() const {
+      return dropped;
+    }
+};
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_RADAR_RING_H_
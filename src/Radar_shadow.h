@@ -0,0 +1,166 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_RADAR_SHADOW_H_
+#define LIB_RADAR_MR24HPC1_SRC_RADAR_SHADOW_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SHADOW_SETTINGS 11  // Setting commands in Radar_Shadow list
+
+// Result of Radar_Shadow::receive()
+#define SHADOW_OK        0
+#define SHADOW_DIVERGED  1  // Radar value is not what was set or known
+
+#define SHADOW_MODE_UNKNOWN 0xFF  // Radar has not told its custom mode
+
+/*
+Last confirmed value of every radar setting, as the raw value
+of its setting frame. SIMPLE and ADVANCED mode settings are separate:
+  0x05 0x07 motion limit (SIMPLE)    0x08 0x0B motion limit (ADVANCED)
+  0x05 0x08 static limit (SIMPLE)    0x08 0x0A static limit (ADVANCED)
+  0x05 0x09 custom mode              0x08 0x08 static threshold
+  0x80 0x0A absence time (SIMPLE)    0x08 0x09 motion threshold
+  0x08 0x0C motion trigger time      0x08 0x0E absence time (ADVANCED)
+  0x08 0x0D motion to static time
+Setting and inquiry responses (command word + 0x80) both confirm.
+Every value is of the custom mode radar had when the value arrived,
+it is not known in other custom modes.
+*/
+class Radar_Shadow {
+ private:
+    struct Entry {
+      uint32_t value;    // Confirmed by radar
+      uint32_t pending;  // Sent, not confirmed yet
+      uint8_t known;
+      uint8_t sent;
+      uint8_t mode;      // Custom mode of value
+    };
+    Entry entries[SHADOW_SETTINGS] = {};
+    uint32_t divergences = 0;
+    uint8_t custom_mode = SHADOW_MODE_UNKNOWN;  // Radar custom mode now
+
+    static int8_t find(uint8_t control_word, uint8_t cmd_word) {
+      static const uint8_t list[SHADOW_SETTINGS][2] = {
+        {0x05, 0x07}, {0x05, 0x08}, {0x05, 0x09},
+        {0x08, 0x08}, {0x08, 0x09}, {0x08, 0x0A}, {0x08, 0x0B},
+        {0x08, 0x0C}, {0x08, 0x0D}, {0x08, 0x0E},
+        {0x80, 0x0A}};
+
+      cmd_word &= 0x7F;  // Inquiry response
+      for (uint8_t i = 0; i < SHADOW_SETTINGS; i++) {
+        if (list[i][0] == control_word && list[i][1] == cmd_word) {
+          return i;
+        }
+      }
+      return -1;
+    }
+
+ public:
+    static bool is_setting(uint8_t control_word, uint8_t cmd_word) {
+      return find(control_word, cmd_word) >= 0;
+    }
+
+    /*
+    true if radar has confirmed this value in custom mode,
+    setting can be skipped
+    */
+    bool is_set(uint8_t control_word, uint8_t cmd_word, uint32_t value,
+                uint8_t mode) const {
+      int8_t i = find(control_word, cmd_word);
+      return i >= 0 && entries[i].known && !entries[i].sent
+        && entries[i].mode == mode && entries[i].value == value;
+    }
+
+    /*
+    Radar told its custom mode (0x05 0x09 or 0x05 0x89 response)
+    changed - setting response, values that came before radar
+    first told its mode are of other mode. Inquiry response tells
+    they are of this mode.
+    */
+    void set_mode(uint8_t mode, bool changed) {
+      int8_t mode_entry = find(0x05, 0x09);
+      for (int8_t i = 0; i < SHADOW_SETTINGS; i++) {
+        if (i != mode_entry && entries[i].mode == SHADOW_MODE_UNKNOWN) {
+          if (changed) {
+            entries[i].known = false;
+          } else {
+            entries[i].mode = mode;
+          }
+        }
+      }
+      entries[mode_entry].mode = mode;  // Custom mode is of every mode
+      custom_mode = mode;
+    }
+
+    /*
+    Setting frame was sent
+    */
+    void send(uint8_t control_word, uint8_t cmd_word, uint32_t value) {
+      int8_t i = find(control_word, cmd_word);
+      if (i >= 0) {
+        entries[i].pending = value;
+        entries[i].sent = true;
+      }
+    }
+
+    /*
+    Radar told its value
+    expected - set to value that was sent or known before
+    Returns SHADOW_DIVERGED if value is different from it.
+    */
+    uint8_t receive(uint8_t control_word, uint8_t cmd_word, uint32_t value,
+                    uint32_t &expected) {
+      int8_t i = find(control_word, cmd_word);
+      if (i < 0) {
+        return SHADOW_OK;
+      }
+
+      Entry &e = entries[i];
+      uint8_t result = SHADOW_OK;
+
+      if (e.sent) {
+        expected = e.pending;
+        result = value == e.pending ? SHADOW_OK : SHADOW_DIVERGED;
+      } else if (e.known && e.mode == custom_mode) {
+        expected = e.value;
+        result = value == e.value ? SHADOW_OK : SHADOW_DIVERGED;
+      }
+
+      e.value = value;
+      e.known = true;
+      e.sent = false;
+      e.mode = custom_mode;
+
+      if (result == SHADOW_DIVERGED) {
+        divergences++;
+      }
+      return result;
+    }
+
+    /*
+    Confirmed value of setting
+    Returns false if radar has not told it yet
+    */
+    bool get(uint8_t control_word, uint8_t cmd_word, uint32_t &value) const {
+      int8_t i = find(control_word, cmd_word);
+      if (i < 0 || !entries[i].known) {
+        return false;
+      }
+      value = entries[i].value;
+      return true;
+    }
+
+    void clear() {  // Next setters are sent again
+      for (uint8_t i = 0; i < SHADOW_SETTINGS; i++) {
+        entries[i].known = false;
+        entries[i].sent = false;
+      }
+    }
+
+    uint32_t get_divergences() const { return divergences; }
+};
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_RADAR_SHADOW_H_
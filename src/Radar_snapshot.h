@@ -0,0 +1,119 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_RADAR_SNAPSHOT_H_
+#define LIB_RADAR_MR24HPC1_SRC_RADAR_SNAPSHOT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+All decoded radar values at one moment
+*/
+struct Radar_State {
+  int   mode;
+  int   heartbeat;
+  // Simple mode
+  int   presence;         // UNOCCUPIED, OCCUPIED
+  int   motion;           // NONE, STATIC, ACTIVE
+  int   activity;         // 0-100
+  int   direction;        // APPROACHING, RECEDING
+  // Advanced mode
+  int   static_energy;    // 0-250
+  int   static_distance;  // cm
+  int   motion_energy;    // 0-250
+  int   motion_distance;  // cm
+  float motion_speed;     // m/s
+  // Settings
+  int   motion_trigger_limit;
+  int   static_trigger_limit;
+  int   motion_energy_threshold;
+  int   static_energy_threshold;
+  int   motion_trigger_time;
+  int   motion_to_static_time;
+  int   time_for_entering_no_person_state;
+  int   custom_mode;
+  int   initialization_status;
+
+  unsigned long updated;  // millis() of last frame
+};
+
+#if defined(__AVR__)
+typedef uint8_t Radar_SeqCount;   // Single byte is atomic on 8-bit MCU
+#else
+typedef uint32_t Radar_SeqCount;
+#endif
+
+/*
+Sequence lock around Radar_State.
+Writer is Radar_MR24HPC1::run(), it never waits.
+Readers on other threads (or main loop, when run() is in an interrupt)
+copy the state and retry only if a write happened meanwhile,
+so every read is one consistent frame, never half of a report.
+One writer only.
+*/
+class Radar_Snapshot {
+ private:
+    Radar_State state = {};
+    Radar_SeqCount sequence = 0;  // Odd while writing
+
+    static void copy(uint8_t *to, const uint8_t *from) {
+      for (size_t i = 0; i < sizeof(Radar_State); i++) {
+        __atomic_store_n(&to[i], __atomic_load_n(&from[i], __ATOMIC_RELAXED),
+                         __ATOMIC_RELAXED);
+      }
+    }
+
+ public:
+    /*
+    Writer: store new state
+    */
+    void publish(const Radar_State &s) {
+      Radar_SeqCount seq = sequence;
+
+      __atomic_store_n(&sequence, static_cast<Radar_SeqCount>(seq + 1),
+                       __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_RELEASE);
+
+      copy(reinterpret_cast<uint8_t *>(&state),
+           reinterpret_cast<const uint8_t *>(&s));
+
+      __atomic_store_n(&sequence, static_cast<Radar_SeqCount>(seq + 2),
+                       __ATOMIC_RELEASE);
+    }
+
+    /*
+    Reader: one try
+    Returns false if writer was busy, s may be torn then
+    */
+    bool try_read(Radar_State &s) const {
+      Radar_SeqCount before = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+      if (before & 1) {
+        return false;
+      }
+
+      copy(reinterpret_cast<uint8_t *>(&s),
+           reinterpret_cast<const uint8_t *>(&state));
+
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      return __atomic_load_n(&sequence, __ATOMIC_RELAXED) == before;
+    }
+
+    /*
+    Reader: consistent copy of last published state
+    */
+    void read(Radar_State &s) const {
+      while (!try_read(s)) {
+      }
+    }
+
+    /*
+    Changes by 2 on every publish, to see if there is something new
+    */
+    Radar_SeqCount get_sequence() const {
+      return __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+    }
+};
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_RADAR_SNAPSHOT_H_
@@ -0,0 +1,222 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_RADAR_STATS_H_
+#define LIB_RADAR_MR24HPC1_SRC_RADAR_STATS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define STATS_ALPHA     0.1f  // Default EWMA weight of new sample
+#define STATS_QUANTILE  0.9f  // Default estimated quantile
+
+// Summary of one value
+struct Radar_StatSummary {
+  uint32_t count;
+  float    min;
+  float    max;
+  float    mean;
+  float    variance;  // Sample variance
+  float    ewma;      // Exponentially weighted moving average
+  float    quantile;  // Estimated, see set_quantile()
+};
+
+/*
+Running statistics of one value, O(1) time and fixed memory per sample.
+Mean and variance with Welford's method,
+quantile with the P-square algorithm (Jain and Chlamtac 1985):
+five markers follow the distribution, no samples are stored.
+*/
+class Radar_Stat {
+ private:
+    uint32_t count = 0;
+    float min = 0;
+    float max = 0;
+    float mean = 0;
+    float m2 = 0;  // Sum of squared differences from mean
+    float ewma = 0;
+    float alpha = STATS_ALPHA;
+
+    // P-square markers
+    float p = STATS_QUANTILE;
+    float q[5] = {0};        // Heights
+    int32_t n[5] = {0};      // Positions
+    float desired[5] = {0};  // Wanted positions
+
+    float parabolic(int i, int d) const {
+      return q[i] + static_cast<float>(d) / (n[i + 1] - n[i - 1])
+        * ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i])
+           + (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+    }
+
+    float linear(int i, int d) const {
+      return q[i] + d * (q[i + d] - q[i]) / (n[i + d] - n[i]);
+    }
+
+    void add_quantile(float x) {
+      if (count <= 5) {
+        // First samples, keep them sorted
+        int i = count - 1;
+        while (i > 0 && q[i - 1] > x) {
+          q[i] = q[i - 1];
+          i--;
+        }
+        q[i] = x;
+
+        if (count == 5) {
+          for (int j = 0; j < 5; j++) {
+            n[j] = j;
+          }
+          desired[0] = 0;
+          desired[1] = 2 * p;
+          desired[2] = 4 * p;
+          desired[3] = 2 + 2 * p;
+          desired[4] = 4;
+        }
+        return;
+      }
+
+      int k;
+      if (x < q[0]) {
+        q[0] = x;
+        k = 0;
+      } else if (x < q[1]) {
+        k = 0;
+      } else if (x < q[2]) {
+        k = 1;
+      } else if (x < q[3]) {
+        k = 2;
+      } else if (x <= q[4]) {
+        k = 3;
+      } else {
+        q[4] = x;
+        k = 3;
+      }
+
+      for (int i = k + 1; i < 5; i++) {
+        n[i]++;
+      }
+      desired[1] += p / 2;
+      desired[2] += p;
+      desired[3] += (1 + p) / 2;
+      desired[4] += 1;
+
+      // Move middle markers toward wanted positions
+      for (int i = 1; i < 4; i++) {
+        float d = desired[i] - n[i];
+
+        if ((d >= 1 && n[i + 1] - n[i] > 1)
+            || (d <= -1 && n[i - 1] - n[i] < -1)) {
+          int step = d > 0 ? 1 : -1;
+          float height = parabolic(i, step);
+
+          if (q[i - 1] < height && height < q[i + 1]) {
+            q[i] = height;
+          } else {
+            q[i] = linear(i, step);
+          }
+          n[i] += step;
+        }
+      }
+    }
+
+ public:
+    /*
+    Add one sample
+    */
+    void add(float x) {
+      count++;
+
+      if (count == 1) {
+        min = x;
+        max = x;
+        ewma = x;
+      } else {
+        if (x < min) {
+          min = x;
+        }
+        if (x > max) {
+          max = x;
+        }
+        ewma += alpha * (x - ewma);
+      }
+
+      float delta = x - mean;
+      mean += delta / count;
+      m2 += delta * (x - mean);
+
+      add_quantile(x);
+    }
+
+    /*
+    EWMA weight of new sample, 0-1
+    */
+    void set_alpha(float a) {
+      alpha = a;
+    }
+
+    /*
+    Quantile to estimate, 0-1, for example 0.5 median or 0.95
+    Starts again from zero samples.
+    */
+    void set_quantile(float quantile) {
+      p = quantile;
+      reset();
+    }
+
+    void reset() {
+      count = 0;
+      mean = 0;
+      m2 = 0;
+    }
+
+    uint32_t get_count() const { return count; }
+    float get_mean() const { return mean; }
+    float get_ewma() const { return ewma; }
+
+    float get_variance() const {
+      return count > 1 ? m2 / (count - 1) : 0;
+    }
+
+    float get_quantile() const {
+      if (count == 0) {
+        return 0;
+      }
+      if (count <= 5) {
+        // Nearest of sorted first samples
+        return q[static_cast<int>(p * (count - 1) + 0.5f)];
+      }
+      return q[2];  // Marker of quantile p
+    }
+
+    void get_summary(Radar_StatSummary &s) const {
+      s.count = count;
+      s.min = min;
+      s.max = max;
+      s.mean = mean;
+      s.variance = get_variance();
+      s.ewma = ewma;
+      s.quantile = get_quantile();
+    }
+};
+
+/*
+Running statistics of energy and distance values
+Radar_MR24HPC1::run() adds every decoded value, see set_stats().
+*/
+struct Radar_Stats {
+  Radar_Stat static_energy;
+  Radar_Stat motion_energy;
+  Radar_Stat static_distance;  // cm
+  Radar_Stat motion_distance;  // cm
+
+  void reset() {
+    static_energy.reset();
+    motion_energy.reset();
+    static_distance.reset();
+    motion_distance.reset();
+  }
+};
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_RADAR_STATS_H_
@@ -0,0 +1,426 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#if !defined(ARDUINO)
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE  // cfmakeraw()
+#endif
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 600  // posix_openpt()
+#endif
+
+#include "Radar_host.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+Clock
+*/
+static uint64_t monotonic_us() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/*
+Time since first call, also from static constructors of other files
+*/
+static uint64_t elapsed_us() {
+  static const uint64_t start_us = monotonic_us();
+  return monotonic_us() - start_us;
+}
+
+unsigned long millis() {
+  return static_cast<unsigned long>(elapsed_us() / 1000);
+}
+
+unsigned long micros() {
+  return static_cast<unsigned long>(elapsed_us());
+}
+
+void delay(unsigned long ms) {
+  struct timespec ts;
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (ms % 1000) * 1000000L;
+  while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+  }
+}
+
+/*
+Print
+*/
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t count = 0;
+
+  while (count < size && write(buffer[count])) {
+    count++;
+  }
+
+  return count;
+}
+
+size_t Print::write(const char *str) {
+  return write(reinterpret_cast<const uint8_t *>(str), strlen(str));
+}
+
+size_t Print::print(const char *str) {
+  return write(str);
+}
+
+size_t Print::print(char c) {
+  return write(static_cast<uint8_t>(c));
+}
+
+size_t Print::print(int value, int base) {
+  return print(static_cast<long>(value), base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+  return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(long value, int base) {
+  if (base == HEX) {
+    return print(static_cast<unsigned long>(value), base);
+  }
+
+  char text[24];
+  snprintf(text, sizeof(text), "%ld", value);
+  return write(text);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  char text[24];
+  snprintf(text, sizeof(text), base == HEX ? "%lX" : "%lu", value);
+  return write(text);
+}
+
+size_t Print::print(double value, int digits) {
+  char text[32];
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return write(text);
+}
+
+size_t Print::println() {
+  return write("\r\n");
+}
+
+size_t Print::println(const char *str) {
+  return print(str) + println();
+}
+
+size_t Print::println(char c) {
+  return print(c) + println();
+}
+
+size_t Print::println(int value, int base) {
+  return print(value, base) + println();
+}
+
+size_t Print::println(unsigned int value, int base) {
+  return print(value, base) + println();
+}
+
+size_t Print::println(long value, int base) {
+  return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long value, int base) {
+  return print(value, base) + println();
+}
+
+size_t Print::println(double value, int digits) {
+  return print(value, digits) + println();
+}
+
+/*
+Log sink
+*/
+static void stdout_sink(const char *text, size_t len) {
+  fwrite(text, 1, len, stdout);
+}
+
+static Radar_LogSink log_sink = stdout_sink;
+
+void radar_set_log_sink(Radar_LogSink sink) {
+  log_sink = sink;
+}
+
+size_t Radar_LogPrint::write(uint8_t byte) {
+  char c = static_cast<char>(byte);
+  return write(reinterpret_cast<const uint8_t *>(&c), 1);
+}
+
+size_t Radar_LogPrint::write(const uint8_t *buffer, size_t size) {
+  if (log_sink != nullptr) {
+    log_sink(reinterpret_cast<const char *>(buffer), size);
+  }
+  return size;
+}
+
+int Radar_LogPrint::availableForWrite() {
+  return 4096;
+}
+
+Radar_LogPrint Serial;
+
+/*
+File print
+*/
+Radar_FilePrint::~Radar_FilePrint() {
+  close();
+}
+
+/*
+Open file for writing, buffered by stdio
+append - add to end of existing file
+*/
+bool Radar_FilePrint::open(const char *path, bool append) {
+  close();
+  file = fopen(path, append ? "ab" : "wb");
+  return file != nullptr;
+}
+
+void Radar_FilePrint::close() {
+  if (file != nullptr) {
+    fclose(file);
+    file = nullptr;
+  }
+}
+
+long Radar_FilePrint::size() {
+  if (file == nullptr) {
+    return 0;
+  }
+  fflush(file);
+  return ftell(file);
+}
+
+size_t Radar_FilePrint::write(uint8_t byte) {
+  return write(&byte, 1);
+}
+
+size_t Radar_FilePrint::write(const uint8_t *buffer, size_t size) {
+  if (file == nullptr) {
+    return 0;
+  }
+  return fwrite(buffer, 1, size, file);
+}
+
+int Radar_FilePrint::availableForWrite() {
+  return file != nullptr ? 4096 : 0;
+}
+
+void Radar_FilePrint::flush() {
+  if (file != nullptr) {
+    fflush(file);
+  }
+}
+
+/*
+Posix stream
+*/
+static speed_t baud_to_speed(uint32_t baud) {
+  switch (baud) {
+    case 9600:
+      return B9600;
+    case 19200:
+      return B19200;
+    case 38400:
+      return B38400;
+    case 57600:
+      return B57600;
+    case 230400:
+      return B230400;
+    case 460800:
+      return B460800;
+    case 921600:
+      return B921600;
+    default:
+      return B115200;
+  }
+}
+
+Radar_PosixStream::~Radar_PosixStream() {
+  close();
+}
+
+/*
+Open serial port in raw, non-blocking mode
+baud - 115200 is radar default
+*/
+bool Radar_PosixStream::open(const char *path, uint32_t baud) {
+  close();
+
+  int new_fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  if (new_fd < 0) {
+    return false;
+  }
+
+  struct termios tio;
+  if (tcgetattr(new_fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, baud_to_speed(baud));
+    cfsetospeed(&tio, baud_to_speed(baud));
+    tio.c_cflag |= CLOCAL | CREAD;
+    tcsetattr(new_fd, TCSANOW, &tio);
+  }
+
+  attach(new_fd);
+  return true;
+}
+
+/*
+Create pseudo-terminal pair
+This stream is master side, radar simulator or test opens slave_path.
+*/
+bool Radar_PosixStream::open_pty(char *slave_path, size_t size) {
+  close();
+
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0) {
+    return false;
+  }
+
+  const char *name = nullptr;
+  if (grantpt(master) != 0 || unlockpt(master) != 0
+      || (name = ptsname(master)) == nullptr || strlen(name) >= size) {
+    ::close(master);
+    return false;
+  }
+  strcpy(slave_path, name);
+
+  // Raw bytes, no echo or line editing
+  struct termios tio;
+  if (tcgetattr(master, &tio) == 0) {
+    cfmakeraw(&tio);
+    tcsetattr(master, TCSANOW, &tio);
+  }
+
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+  fcntl(master, F_SETFD, FD_CLOEXEC);
+  attach(master);
+  return true;
+}
+
+/*
+Use already open descriptor, stream closes it
+*/
+void Radar_PosixStream::attach(int new_fd) {
+  fd = new_fd;
+  rx_pos = 0;
+  rx_len = 0;
+}
+
+void Radar_PosixStream::close() {
+  if (fd >= 0) {
+    ::close(fd);
+  }
+  attach(-1);
+}
+
+/*
+Read what is available to rx buffer
+*/
+size_t Radar_PosixStream::fill() {
+  if (rx_pos < rx_len) {
+    return rx_len - rx_pos;
+  }
+
+  rx_pos = 0;
+  rx_len = 0;
+
+  if (fd < 0) {
+    return 0;
+  }
+
+  ssize_t count = ::read(fd, rx_buffer, sizeof(rx_buffer));
+  if (count > 0) {
+    rx_len = static_cast<size_t>(count);
+  }
+
+  return rx_len;
+}
+
+int Radar_PosixStream::available() {
+  return static_cast<int>(fill());
+}
+
+int Radar_PosixStream::read() {
+  if (fill() == 0) {
+    return -1;
+  }
+  return rx_buffer[rx_pos++];
+}
+
+int Radar_PosixStream::peek() {
+  if (fill() == 0) {
+    return -1;
+  }
+  return rx_buffer[rx_pos];
+}
+
+/*
+Copy available bytes, never waits
+*/
+size_t Radar_PosixStream::read_bytes(uint8_t *buffer, size_t size) {
+  size_t count = 0;
+
+  while (count < size && fill() > 0) {
+    size_t n = rx_len - rx_pos;
+    if (n > size - count) {
+      n = size - count;
+    }
+    memcpy(buffer + count, rx_buffer + rx_pos, n);
+    rx_pos += n;
+    count += n;
+  }
+
+  return count;
+}
+
+size_t Radar_PosixStream::write(uint8_t byte) {
+  return write(&byte, 1);
+}
+
+/*
+Write all bytes, waits only if kernel buffer is full
+*/
+size_t Radar_PosixStream::write(const uint8_t *buffer, size_t size) {
+  size_t count = 0;
+
+  while (fd >= 0 && count < size) {
+    ssize_t n = ::write(fd, buffer + count, size - count);
+
+    if (n > 0) {
+      count += static_cast<size_t>(n);
+    } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+      break;
+    } else if (errno == EAGAIN) {
+      delay(1);
+    }
+  }
+
+  return count;
+}
+
+int Radar_PosixStream::availableForWrite() {
+  return fd >= 0 ? 4096 : 0;
+}
+
+void Radar_PosixStream::flush() {
+  if (fd >= 0 && isatty(fd)) {
+    tcdrain(fd);
+  }
+}
+
+#endif  // !ARDUINO
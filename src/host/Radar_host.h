@@ -0,0 +1,152 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_HOST_RADAR_HOST_H_
+#define LIB_RADAR_MR24HPC1_SRC_HOST_RADAR_HOST_H_
+
+/*
+Host platform layer, used when library is built without Arduino.
+Gives the small part of Arduino API the library needs:
+Print, Stream, millis(), micros(), delay(), PROGMEM and Serial.
+Serial output goes to a log sink, stdout by default.
+*/
+
+#if !defined(ARDUINO)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define HEX 16
+#define DEC 10
+
+// Flash data is normal memory on host
+#define PROGMEM
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t *>(addr))
+#define memcpy_P memcpy
+
+unsigned long millis();  // Monotonic clock
+unsigned long micros();
+void delay(unsigned long ms);
+
+/*
+Arduino Print subset
+*/
+class Print {
+ public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t byte) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *str);
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const char *str);
+    size_t print(char c);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println();
+    size_t println(const char *str);
+    size_t println(char c);
+    size_t println(int value, int base = DEC);
+    size_t println(unsigned int value, int base = DEC);
+    size_t println(long value, int base = DEC);
+    size_t println(unsigned long value, int base = DEC);
+    size_t println(double value, int digits = 2);
+};
+
+/*
+Arduino Stream subset
+*/
+class Stream : public Print {
+ public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+/*
+Log sink gets every Serial.print() text
+nullptr discards log
+*/
+typedef void (*Radar_LogSink)(const char *text, size_t len);
+
+void radar_set_log_sink(Radar_LogSink sink);
+
+class Radar_LogPrint : public Print {
+ public:
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int availableForWrite() override;  // Sink never waits
+};
+
+extern Radar_LogPrint Serial;
+
+/*
+Print to a file, for Radar_Recorder captures
+*/
+class Radar_FilePrint : public Print {
+ private:
+    FILE *file = nullptr;
+
+ public:
+    ~Radar_FilePrint();
+
+    bool open(const char *path, bool append = false);
+    void close();
+    bool is_open() const { return file != nullptr; }
+    long size();  // Bytes in file
+
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int availableForWrite() override;
+    void flush() override;
+};
+
+/*
+Byte stream on a file descriptor: serial port or pseudo-terminal
+Reads are non-blocking and buffered, so available() and read()
+don't make a system call for every byte.
+*/
+class Radar_PosixStream : public Stream {
+ private:
+    int fd = -1;
+    uint8_t rx_buffer[256];
+    size_t rx_pos = 0;
+    size_t rx_len = 0;
+
+    size_t fill();
+
+ public:
+    ~Radar_PosixStream();
+
+    bool open(const char *path, uint32_t baud = 115200);  // Serial port
+    bool open_pty(char *slave_path, size_t size);  // New pty, this is master
+    void attach(int fd);  // Already open descriptor
+    void close();
+    int get_fd() const { return fd; }
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t read_bytes(uint8_t *buffer, size_t size);  // Only available bytes
+
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int availableForWrite() override;
+    void flush() override;
+};
+
+#endif  // !ARDUINO
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_HOST_RADAR_HOST_H_
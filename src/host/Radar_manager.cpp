@@ -0,0 +1,363 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#if !defined(ARDUINO)
+
+#include "Radar_manager.h"
+
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#define MANAGER_EVENTS 64  // epoll events per wait
+
+/*
+First poll of radar id, as offset from now
+Bit reversed id is its place in the interval: 0, 1/2, 1/4, 3/4, 1/8 ...
+so radars are spread evenly for any count, also when added later.
+*/
+static unsigned long poll_phase(uint32_t interval, int id) {
+  uint32_t v = static_cast<uint32_t>(id);
+  v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
+  v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
+  v = ((v >> 4) & 0x0F0F0F0F) | ((v & 0x0F0F0F0F) << 4);
+  v = ((v >> 8) & 0x00FF00FF) | ((v & 0x00FF00FF) << 8);
+  v = (v >> 16) | (v << 16);
+  return (static_cast<uint64_t>(interval) * v) >> 32;
+}
+
+Radar_Manager::Radar_Manager() {
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+}
+
+Radar_Manager::~Radar_Manager() {
+  for (int i = 0; i < devices_count; i++) {
+    delete devices[i].radar;
+    delete devices[i].port;
+  }
+  free(devices);
+
+  if (epoll_fd >= 0) {
+    close(epoll_fd);
+  }
+}
+
+/*
+Add open port, manager deletes it
+New radar instance is made for it.
+Returns radar id, or -1 and port is still owned by caller
+*/
+int Radar_Manager::add(Radar_PosixStream *port) {
+  if (epoll_fd < 0 || port == nullptr || port->get_fd() < 0) {
+    return -1;
+  }
+
+  if (devices_count == devices_size) {
+    int new_size = devices_size > 0 ? devices_size * 2 : 16;
+    Device *new_devices = static_cast<Device *>(
+      realloc(devices, new_size * sizeof(Device)));
+    if (new_devices == nullptr) {
+      return -1;
+    }
+    devices = new_devices;
+    devices_size = new_size;
+  }
+
+  int id = devices_count;
+
+  struct epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.u32 = id;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, port->get_fd(), &ev) != 0) {
+    return -1;
+  }
+
+  Device &d = devices[id];
+  d.port = port;
+  d.radar = new Radar_MR24HPC1(port);
+  d.radar->set_flush(false);  // Don't wait for UART on a shared thread
+  d.open = true;
+
+  for (uint8_t i = 0; i < MANAGER_MAX_POLLS; i++) {
+    d.next_poll[i] = 0;
+  }
+
+  devices_count++;
+
+  // Spread existing polls of the new radar
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < polls_count; i++) {
+    d.next_poll[i] = now + poll_phase(polls[i].interval, id);
+  }
+
+  return id;
+}
+
+/*
+Open serial port and add it
+*/
+int Radar_Manager::add(const char *path, uint32_t baud) {
+  Radar_PosixStream *port = new Radar_PosixStream();
+
+  if (!port->open(path, baud)) {
+    delete port;
+    return -1;
+  }
+
+  int id = add(port);
+  if (id < 0) {
+    delete port;
+  }
+  return id;
+}
+
+bool Radar_Manager::is_open(int id) const {
+  return id >= 0 && id < devices_count && devices[id].open;
+}
+
+Radar_MR24HPC1 *Radar_Manager::get(int id) {
+  if (id < 0 || id >= devices_count) {
+    return nullptr;
+  }
+  return devices[id].radar;
+}
+
+Radar_PosixStream *Radar_Manager::get_port(int id) {
+  if (id < 0 || id >= devices_count) {
+    return nullptr;
+  }
+  return devices[id].port;
+}
+
+/*
+Stop using radar: port is closed, radar and port deleted
+get(id) returns nullptr after this, ids of other radars stay.
+*/
+void Radar_Manager::remove(int id) {
+  if (id < 0 || id >= devices_count || devices[id].radar == nullptr) {
+    return;
+  }
+
+  Device &d = devices[id];
+  drop(id);
+  delete d.radar;
+  delete d.port;
+  d.radar = nullptr;
+  d.port = nullptr;
+}
+
+/*
+For callbacks: which radar called
+*/
+int Radar_Manager::find(const Radar_MR24HPC1 *radar) const {
+  if (radar == nullptr) {
+    return -1;
+  }
+  for (int i = 0; i < devices_count; i++) {
+    if (devices[i].radar == radar) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/*
+Port closed or failed: stop watching it
+Radar stays, so id and its state are still valid.
+*/
+void Radar_Manager::drop(int id) {
+  Device &d = devices[id];
+
+  if (d.open) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, d.port->get_fd(), nullptr);
+    d.port->close();
+    d.open = false;
+  }
+}
+
+/*
+Query sent to every radar every interval_ms
+Radars are spread over the interval, not all at once.
+Returns false if MANAGER_MAX_POLLS is used.
+*/
+bool Radar_Manager::poll_every(Radar_Ask ask, uint32_t interval_ms) {
+  if (polls_count >= MANAGER_MAX_POLLS || interval_ms == 0) {
+    return false;
+  }
+
+  uint8_t p = polls_count++;
+  polls[p].ask = ask;
+  polls[p].interval = interval_ms;
+
+  unsigned long now = millis();
+  for (int i = 0; i < devices_count; i++) {
+    devices[i].next_poll[p] = now + poll_phase(interval_ms, i);
+  }
+
+  return true;
+}
+
+/*
+Max queries sent in one run(), 0 no limit
+The rest go out on next calls.
+*/
+void Radar_Manager::set_max_queries(uint16_t count) {
+  max_queries = count;
+}
+
+/*
+Send due queries
+Queries due for one radar go out with one write.
+*/
+void Radar_Manager::send_polls(unsigned long now) {
+  if (polls_count == 0 || devices_count == 0) {
+    return;
+  }
+
+  uint16_t sent = 0;
+  int start = next_device;
+
+  for (int n = 0; n < devices_count; n++) {
+    int id = (start + n) % devices_count;
+    Device &d = devices[id];
+
+    if (!d.open) {
+      continue;
+    }
+
+    bool batch = false;
+
+    for (uint8_t p = 0; p < polls_count; p++) {
+      if (static_cast<long>(now - d.next_poll[p]) < 0) {
+        continue;
+      }
+
+      if (max_queries > 0 && sent >= max_queries) {
+        next_device = id;  // Continue here next time
+        if (batch) {
+          d.radar->end_batch();
+        }
+        queries_sent += sent;
+        return;
+      }
+
+      if (!batch) {
+        d.radar->begin_batch();
+        batch = true;
+      }
+
+      (d.radar->*polls[p].ask)();
+      d.next_poll[p] += polls[p].interval;
+      if (static_cast<long>(now - d.next_poll[p]) >= 0) {
+        d.next_poll[p] = now + polls[p].interval;  // Was late, don't burst
+      }
+      sent++;
+    }
+
+    if (batch) {
+      d.radar->end_batch();
+    }
+  }
+
+  queries_sent += sent;
+  next_device = (start + 1) % devices_count;
+}
+
+/*
+ms until some query is due, -1 if none
+*/
+int Radar_Manager::time_to_next_poll(unsigned long now) {
+  long wait = -1;
+
+  for (int i = 0; i < devices_count; i++) {
+    if (!devices[i].open) {
+      continue;
+    }
+    for (uint8_t p = 0; p < polls_count; p++) {
+      long left = static_cast<long>(devices[i].next_poll[p] - now);
+      if (left < 0) {
+        left = 0;
+      }
+      if (wait < 0 || left < wait) {
+        wait = left;
+      }
+    }
+  }
+
+  return static_cast<int>(wait);
+}
+
+/*
+ms until some request times out, -1 if none
+*/
+int Radar_Manager::time_to_deadline() {
+  long wait = -1;
+
+  for (int i = 0; i < devices_count; i++) {
+    if (!devices[i].open) {
+      continue;
+    }
+    long left = devices[i].radar->time_to_deadline();
+    if (left >= 0 && (wait < 0 || left < wait)) {
+      wait = left;
+    }
+  }
+
+  return static_cast<int>(wait);
+}
+
+/*
+Runs on the loop
+Sleeps in epoll until a port has data, a query is due
+or a request times out.
+timeout_ms - longest wait, -1 no limit
+*/
+int Radar_Manager::run(int timeout_ms, bool mode) {
+  unsigned long now = millis();
+  send_polls(now);
+
+  int wait = time_to_next_poll(now);
+  int deadline = time_to_deadline();
+  if (deadline >= 0 && (wait < 0 || deadline < wait)) {
+    wait = deadline;
+  }
+  if (wait < 0 || (timeout_ms >= 0 && timeout_ms < wait)) {
+    wait = timeout_ms;
+  }
+
+  struct epoll_event ev[MANAGER_EVENTS];
+  int n = epoll_wait(epoll_fd, ev, MANAGER_EVENTS, wait);
+  if (n < 0) {
+    n = 0;  // EINTR
+  }
+
+  for (int i = 0; i < n; i++) {
+    int id = static_cast<int>(ev[i].data.u32);
+    Device &d = devices[id];
+
+    if (!d.open) {
+      continue;  // Removed by callback of other radar
+    }
+
+    if (ev[i].events & EPOLLIN) {
+      d.radar->run(mode);  // Reads until port is empty
+    }
+
+    if (ev[i].events & (EPOLLERR | EPOLLHUP)) {
+      drop(id);
+    }
+  }
+
+  // Timeouts of radars without data
+  for (int i = 0; i < devices_count; i++) {
+    if (devices[i].open) {
+      devices[i].radar->update_requests();
+    }
+  }
+
+  events += n;
+  return n;
+}
+
+#endif  // !ARDUINO
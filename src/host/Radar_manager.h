@@ -0,0 +1,83 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_HOST_RADAR_MANAGER_H_
+#define LIB_RADAR_MR24HPC1_SRC_HOST_RADAR_MANAGER_H_
+
+/*
+Many radars on one thread, Linux only.
+Serial ports are watched with epoll, radar run() is called only
+when its port has data. Periodic queries are shared by all radars
+and spread over time, so they don't go out at the same moment.
+The loop also wakes up when a query is due or a request times out.
+*/
+
+#if !defined(ARDUINO)
+
+#include "../Radar_MR24HPC1.h"
+
+#ifndef MANAGER_MAX_POLLS
+#define MANAGER_MAX_POLLS 8  // Periodic queries
+#endif
+
+typedef Radar_Request (Radar_MR24HPC1::*Radar_Ask)();
+
+class Radar_Manager {
+ private:
+    struct Device {
+      Radar_PosixStream *port;
+      Radar_MR24HPC1 *radar;
+      unsigned long next_poll[MANAGER_MAX_POLLS];  // millis()
+      bool open;
+    };
+    struct Poll {
+      Radar_Ask ask;
+      uint32_t interval;  // ms
+    };
+
+    int epoll_fd = -1;
+    Device *devices = nullptr;
+    int devices_count = 0;
+    int devices_size = 0;  // Allocated
+    Poll polls[MANAGER_MAX_POLLS];
+    uint8_t polls_count = 0;
+    uint16_t max_queries = 0;  // Per run(), 0 no limit
+    int next_device = 0;       // Round robin start of sending
+    uint32_t events = 0;
+    uint32_t queries_sent = 0;
+
+    void drop(int id);
+    void send_polls(unsigned long now);
+    int time_to_next_poll(unsigned long now);
+    int time_to_deadline();
+
+ public:
+    Radar_Manager();
+    ~Radar_Manager();
+
+    // Takes ownership and returns id, on error -1 and caller keeps port
+    int add(Radar_PosixStream *port);
+    int add(const char *path, uint32_t baud = 115200);  // -1 on error
+    void remove(int id);  // Closes port and deletes radar, id is not reused
+    int count() const { return devices_count; }
+    bool is_open(int id) const;
+    Radar_MR24HPC1 *get(int id);
+    Radar_PosixStream *get_port(int id);
+    int find(const Radar_MR24HPC1 *radar) const;  // id of radar, -1 if none
+
+    // Every radar gets this query every interval_ms
+    bool poll_every(Radar_Ask ask, uint32_t interval_ms);
+    void set_max_queries(uint16_t count);  // Spread bursts over run() calls
+
+    // Waits up to timeout_ms for data or next query, -1 forever
+    // Returns number of ports that had data
+    int run(int timeout_ms, bool mode = NONVERBAL);
+
+    uint32_t get_events() const { return events; }
+    uint32_t get_queries_sent() const { return queries_sent; }
+};
+
+#endif  // !ARDUINO
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_HOST_RADAR_MANAGER_H_
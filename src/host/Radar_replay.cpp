@@ -0,0 +1,142 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#if !defined(ARDUINO)
+
+#include "Radar_replay.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Radar_Replay::~Radar_Replay() {
+  close();
+}
+
+/*
+Map capture file to memory
+*/
+bool Radar_Replay::open(const char *path) {
+  close();
+
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < CAPTURE_HEADER_SIZE) {
+    ::close(fd);
+    return false;
+  }
+
+  void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);  // Mapping stays
+  if (map == MAP_FAILED) {
+    return false;
+  }
+
+  data = static_cast<const uint8_t *>(map);
+  size = st.st_size;
+
+  if (memcmp(data, "RCAP", 4) != 0 || data[4] != CAPTURE_VERSION
+      || data[5] < CAPTURE_RECORD_HEADER) {
+    close();
+    return false;
+  }
+
+  madvise(map, size, MADV_SEQUENTIAL);
+  record_header = data[5];
+  rewind();
+  return true;
+}
+
+void Radar_Replay::close() {
+  if (data != nullptr) {
+    munmap(const_cast<uint8_t *>(data), size);
+  }
+  data = nullptr;
+  size = 0;
+  pos = 0;
+}
+
+void Radar_Replay::rewind() {
+  pos = CAPTURE_HEADER_SIZE;
+  time = 0;
+  first = true;
+}
+
+/*
+Next record, frame is not copied
+Returns false at end or at a record that was not fully written
+*/
+bool Radar_Replay::next(Radar_ReplayRecord &r) {
+  if (data == nullptr || pos + record_header > size) {
+    return false;
+  }
+
+  const uint8_t *h = data + pos;
+  if (pos + record_header + h[0] > size) {
+    return false;
+  }
+
+  uint32_t raw_time = h[2] | (h[3] << 8) | (h[4] << 16)
+                    | (static_cast<uint32_t>(h[5]) << 24);
+  if (!first) {
+    time += static_cast<uint32_t>(raw_time - last_time);  // Over the wrap
+  }
+  first = false;
+  last_time = raw_time;
+
+  r.time = time;
+  r.flags = h[1];
+  r.len = h[0];
+  r.frame = h + record_header;
+
+  pos += record_header + h[0];
+  return true;
+}
+
+/*
+Feed received frames or raw bytes to radar
+Sent queries and BAD frames are skipped: frames the parser found
+inside a broken frame have their own records. Raw records are
+fed as they came, so broken frames are parsed again too.
+Radar's own stream is not read, live bytes are not mixed in.
+*/
+uint32_t Radar_Replay::play(Radar_MR24HPC1 *radar, bool realtime, bool mode,
+                            Radar_ReplayCallback callback, void *user) {
+  Radar_ReplayRecord r;
+  uint32_t count = 0;
+  uint64_t start = micros();
+
+  while (next(r)) {
+    if ((r.flags & (CAPTURE_TX | CAPTURE_BAD)) != 0) {
+      continue;
+    }
+
+    if (realtime) {
+      uint64_t now = micros() - start;
+      if (r.time > now) {
+        usleep(r.time - now);
+      }
+    }
+
+    size_t used = 0;
+    while (used < r.len) {
+      used += radar->feed(r.frame + used, r.len - used);
+      radar->run_fed(mode);
+    }
+
+    count++;
+    if (callback != nullptr) {
+      callback(radar, r, user);
+    }
+  }
+
+  return count;
+}
+
+#endif  // !ARDUINO
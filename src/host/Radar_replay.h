@@ -0,0 +1,63 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_HOST_RADAR_REPLAY_H_
+#define LIB_RADAR_MR24HPC1_SRC_HOST_RADAR_REPLAY_H_
+
+/*
+Capture file replay, Linux only.
+File made by Radar_Recorder is memory-mapped and its received
+frames or raw bytes are fed to the parser and handlers, as fast
+as possible or with the recorded timing.
+*/
+
+#if !defined(ARDUINO)
+
+#include "../Radar_MR24HPC1.h"
+
+// One record of capture, frame points into mapped file
+struct Radar_ReplayRecord {
+  uint64_t time;         // us from first record, wraps are removed
+  uint8_t flags;         // CAPTURE_TX, CAPTURE_BAD, CAPTURE_RAW
+  uint8_t len;
+  const uint8_t *frame;
+};
+
+// Called after every replayed record is processed
+typedef void (*Radar_ReplayCallback)(Radar_MR24HPC1 *radar,
+                                     const Radar_ReplayRecord &record,
+                                     void *user);
+
+class Radar_Replay {
+ private:
+    const uint8_t *data = nullptr;  // Mapped file
+    size_t size = 0;
+    size_t pos = 0;
+    uint8_t record_header = CAPTURE_RECORD_HEADER;
+    uint32_t last_time = 0;
+    uint64_t time = 0;
+    bool first = true;
+
+ public:
+    ~Radar_Replay();
+
+    bool open(const char *path);  // false if missing, not a capture
+                                  // or of unknown version
+    void close();
+    void rewind();                // Back to first record
+
+    bool next(Radar_ReplayRecord &r);  // false at end of file
+
+    // Feed received records to radar and run_fed() it, stream is not read
+    // realtime - wait between records as recorded
+    // Returns number of records fed
+    uint32_t play(Radar_MR24HPC1 *radar, bool realtime = false,
+                  bool mode = NONVERBAL,
+                  Radar_ReplayCallback callback = nullptr,
+                  void *user = nullptr);
+};
+
+#endif  // !ARDUINO
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_HOST_RADAR_REPLAY_H_
@@ -0,0 +1,579 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#if !defined(ARDUINO)
+
+#include "Radar_simulator.h"
+
+#include <stdlib.h>
+
+/*
+Memory stream
+*/
+Radar_MemoryStream::~Radar_MemoryStream() {
+  free(rx_buffer);
+}
+
+/*
+Connect both ends of the pipe
+*/
+void Radar_MemoryStream::connect(Radar_MemoryStream *other) {
+  peer = other;
+  if (other != nullptr) {
+    other->peer = this;
+  }
+}
+
+void Radar_MemoryStream::clear() {
+  rx_pos = 0;
+  rx_len = 0;
+}
+
+/*
+Bytes from peer, buffer grows as needed
+*/
+void Radar_MemoryStream::receive(const uint8_t *buffer, size_t size) {
+  if (rx_pos == rx_len) {
+    clear();
+  }
+
+  if (rx_len + size > rx_size) {
+    // Move unread bytes to start before growing
+    if (rx_pos > 0) {
+      memmove(rx_buffer, rx_buffer + rx_pos, rx_len - rx_pos);
+      rx_len -= rx_pos;
+      rx_pos = 0;
+    }
+
+    if (rx_len + size > rx_size) {
+      size_t new_size = rx_size > 0 ? rx_size : 256;
+      while (new_size < rx_len + size) {
+        new_size *= 2;
+      }
+      uint8_t *new_buffer = static_cast<uint8_t *>(realloc(rx_buffer, new_size));
+      if (new_buffer == nullptr) {
+        return;
+      }
+      rx_buffer = new_buffer;
+      rx_size = new_size;
+    }
+  }
+
+  memcpy(rx_buffer + rx_len, buffer, size);
+  rx_len += size;
+}
+
+int Radar_MemoryStream::available() {
+  return static_cast<int>(rx_len - rx_pos);
+}
+
+int Radar_MemoryStream::read() {
+  if (rx_pos == rx_len) {
+    return -1;
+  }
+  return rx_buffer[rx_pos++];
+}
+
+int Radar_MemoryStream::peek() {
+  if (rx_pos == rx_len) {
+    return -1;
+  }
+  return rx_buffer[rx_pos];
+}
+
+size_t Radar_MemoryStream::read_bytes(uint8_t *buffer, size_t size) {
+  size_t count = rx_len - rx_pos;
+  if (count > size) {
+    count = size;
+  }
+  memcpy(buffer, rx_buffer + rx_pos, count);
+  rx_pos += count;
+  return count;
+}
+
+size_t Radar_MemoryStream::write(uint8_t byte) {
+  return write(&byte, 1);
+}
+
+size_t Radar_MemoryStream::write(const uint8_t *buffer, size_t size) {
+  if (peer == nullptr) {
+    return 0;
+  }
+  peer->receive(buffer, size);
+  return size;
+}
+
+int Radar_MemoryStream::availableForWrite() {
+  return peer != nullptr ? 4096 : 0;
+}
+
+/*
+Simulator
+*/
+Radar_Simulator::Radar_Simulator(Stream *s) {
+  stream = s;
+  random_state = config.seed;
+}
+
+void Radar_Simulator::set_config(const Radar_SimConfig &c) {
+  config = c;
+  random_state = c.seed != 0 ? c.seed : 1;
+  next_sensor_report = now;
+  next_presence_report = now;
+  next_heartbeat = now;
+}
+
+void Radar_Simulator::set_scene(const Radar_SimScene &s) {
+  scene = s;
+}
+
+/*
+Runs on the loop
+Reads queries, sends replies and reports that are due
+*/
+void Radar_Simulator::run(unsigned long now_ms) {
+  now = now_ms;
+
+  while (stream->available() > 0) {
+    parse_byte(static_cast<uint8_t>(stream->read()));
+  }
+
+  // Delayed replies in order they were queued
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < replies_count; i++) {
+    if (static_cast<long>(now - replies[i].due) >= 0) {
+      stream->write(replies[i].bytes, replies[i].len);
+      stats.bytes_sent += replies[i].len;
+      stats.replies++;
+    } else {
+      if (kept != i) {
+        replies[kept] = replies[i];
+      }
+      kept++;
+    }
+  }
+  replies_count = kept;
+
+  send_reports();
+}
+
+/*
+Query parser, same frame rules as the library
+*/
+void Radar_Simulator::parse_byte(uint8_t byte) {
+  if (rx_len == I_HEAD1 && byte != HEAD1) {
+    return;
+  }
+  if (rx_len == I_HEAD2 && byte != HEAD2) {
+    rx_len = (byte == HEAD1) ? 1 : 0;
+    return;
+  }
+
+  rx[rx_len++] = byte;
+
+  if (rx_len == I_DATA) {
+    rx_expected = ((rx[I_LENGHT_H] << 8) | rx[I_LENGHT_L]) + FRAME_OVERHEAD;
+    if (rx_expected > FRAME_SIZE) {
+      stats.bad_frames++;
+      rx_len = 0;
+    }
+    return;
+  }
+
+  if (rx_len < I_DATA || rx_len < rx_expected) {
+    return;
+  }
+
+  rx_len = 0;
+
+  uint8_t sum = 0;
+  for (int i = 0; i < rx_expected - 3; i++) {
+    sum += rx[i];
+  }
+
+  if (sum != rx[rx_expected - 3] || rx[rx_expected - 2] != END1
+      || rx[rx_expected - 1] != END2) {
+    stats.bad_frames++;
+    return;
+  }
+
+  stats.queries++;
+  answer(rx);
+}
+
+/*
+Reply to query like radar does
+Settings are echoed back, inquiries get current value.
+*/
+void Radar_Simulator::answer(const uint8_t *frame) {
+  uint8_t control_word = frame[I_CONTROL_WORD];
+  uint8_t cmd_word = frame[I_CMD_WORD];
+  uint16_t len = (frame[I_LENGHT_H] << 8) | frame[I_LENGHT_L];
+  uint8_t value = frame[I_DATA];
+  uint32_t value32 = 0;
+  if (len >= 4) {
+    value32 = (static_cast<uint32_t>(frame[I_DATA]) << 24)
+            | (static_cast<uint32_t>(frame[I_DATA + 1]) << 16)
+            | (static_cast<uint32_t>(frame[I_DATA + 2]) << 8)
+            | frame[I_DATA + 3];
+  }
+
+  switch ((control_word << 8) | cmd_word) {
+    // System
+    case 0x0101:
+      reply_u8(0x01, 0x01, 0x0F);
+      break;
+    case 0x0102:
+      reply_u8(0x01, 0x02, 0x0F);
+      reply_u8(0x05, 0x01, 0x0F);  // Init completed after reset
+      break;
+    // Product information
+    case 0x02A1:
+      reply_text(0x02, 0xA1, product_model);
+      break;
+    case 0x02A2:
+      reply_text(0x02, 0xA2, product_id);
+      break;
+    case 0x02A3:
+      reply_text(0x02, 0xA3, hardware_model);
+      break;
+    case 0x02A4:
+      reply_text(0x02, 0xA4, firmware_version);
+      break;
+    // Work status
+    case 0x0507:
+      scene_setting = value;
+      reply_u8(0x05, 0x07, value);
+      break;
+    case 0x0508:
+      sensitivity = value;
+      reply_u8(0x05, 0x08, value);
+      break;
+    case 0x0509:
+      custom_mode = value;
+      reply_u8(0x05, 0x09, value);
+      break;
+    case 0x050A:
+      reply_u8(0x05, 0x0A, 0x0F);
+      break;
+    case 0x0581:
+      reply_u8(0x05, 0x81, 0x01);
+      break;
+    case 0x0585:
+      reply_u8(0x05, 0x85, speed_byte(scene.motion_speed));
+      break;
+    case 0x0587:
+      reply_u8(0x05, 0x87, scene_setting);
+      break;
+    case 0x0588:
+      reply_u8(0x05, 0x88, sensitivity);
+      break;
+    case 0x0589:
+      reply_u8(0x05, 0x89, custom_mode);
+      break;
+    // Underlying open function
+    case 0x0800:
+      mode = (value == 0x01) ? ADVANCED : SIMPLE;
+      reply_u8(0x08, 0x00, value);
+      break;
+    case 0x0880:
+      reply_u8(0x08, 0x80, mode == ADVANCED ? 0x01 : 0x00);
+      break;
+    case 0x0881:
+      reply_u8(0x08, 0x81, noisy(scene.static_energy, 250, 0, 250));
+      break;
+    case 0x0882:
+      reply_u8(0x08, 0x82, noisy(scene.motion_energy, 250, 0, 250));
+      break;
+    case 0x0883:
+      reply_u8(0x08, 0x83, distance_byte(scene.static_distance));
+      break;
+    case 0x0884:
+      reply_u8(0x08, 0x84, distance_byte(scene.motion_distance));
+      break;
+    case 0x0808:
+      static_threshold = value;
+      reply_u8(0x08, 0x08, value);
+      break;
+    case 0x0809:
+      motion_threshold = value;
+      reply_u8(0x08, 0x09, value);
+      break;
+    case 0x0888:
+      reply_u8(0x08, 0x88, static_threshold);
+      break;
+    case 0x0889:
+      reply_u8(0x08, 0x89, motion_threshold);
+      break;
+    case 0x080A:
+      static_limit = value;
+      reply_u8(0x08, 0x0A, value);
+      break;
+    case 0x080B:
+      motion_limit = value;
+      reply_u8(0x08, 0x0B, value);
+      break;
+    case 0x088A:
+      reply_u8(0x08, 0x8A, static_limit);
+      break;
+    case 0x088B:
+      reply_u8(0x08, 0x8B, motion_limit);
+      break;
+    case 0x080C:
+      motion_trigger_time = value32;
+      reply_u32(0x08, 0x0C, value32);
+      break;
+    case 0x080D:
+      motion_to_static_time = value32;
+      reply_u32(0x08, 0x0D, value32);
+      break;
+    case 0x080E:
+      no_person_time = value32;
+      reply_u32(0x08, 0x0E, value32);
+      break;
+    case 0x088C:
+      reply_u32(0x08, 0x8C, motion_trigger_time);
+      break;
+    case 0x088D:
+      reply_u32(0x08, 0x8D, motion_to_static_time);
+      break;
+    case 0x088E:
+      reply_u32(0x08, 0x8E, no_person_time);
+      break;
+    // Human presence
+    case 0x8081:
+      reply_u8(0x80, 0x81, scene.presence);
+      break;
+    case 0x8082:
+      reply_u8(0x80, 0x82, scene.motion);
+      break;
+    case 0x8083:
+      reply_u8(0x80, 0x83, noisy(scene.activity, 100, 0, 100));
+      break;
+    case 0x800A:
+      no_person_code = value;
+      reply_u8(0x80, 0x0A, value);
+      break;
+    case 0x808A:
+      reply_u8(0x80, 0x8A, no_person_code);
+      break;
+    case 0x808B:
+      reply_u8(0x80, 0x8B, proximity);
+      break;
+    default:
+      stats.unknown++;
+      break;
+  }
+}
+
+/*
+Unsolicited reports when they are due
+*/
+void Radar_Simulator::send_reports() {
+  if (config.heartbeat_ms > 0
+      && static_cast<long>(now - next_heartbeat) >= 0) {
+    next_heartbeat = now + config.heartbeat_ms;
+    uint8_t data = 0x0F;
+    send_frame(0x01, 0x01, &data, 1);
+    stats.reports++;
+  }
+
+  if (config.sensor_report_ms > 0 && mode == ADVANCED
+      && static_cast<long>(now - next_sensor_report) >= 0) {
+    next_sensor_report = now + config.sensor_report_ms;
+    uint8_t data[5];
+    data[0] = noisy(scene.static_energy, 250, 0, 250);
+    data[1] = distance_byte(scene.static_distance);
+    data[2] = noisy(scene.motion_energy, 250, 0, 250);
+    data[3] = distance_byte(scene.motion_distance);
+    data[4] = speed_byte(scene.motion_speed);
+    send_frame(0x08, 0x01, data, sizeof(data));
+    stats.reports++;
+  }
+
+  if (config.presence_report_ms > 0
+      && static_cast<long>(now - next_presence_report) >= 0) {
+    next_presence_report = now + config.presence_report_ms;
+    uint8_t data = scene.presence;
+    send_frame(0x80, 0x01, &data, 1);
+    data = scene.motion;
+    send_frame(0x80, 0x02, &data, 1);
+    stats.reports += 2;
+
+    if (mode == SIMPLE) {
+      data = noisy(scene.activity, 100, 0, 100);
+      send_frame(0x80, 0x03, &data, 1);
+      proximity = NONE;
+      if (scene.motion_speed > 0) {
+        proximity = APPROACHING;
+      } else if (scene.motion_speed < 0) {
+        proximity = RECEDING;
+      }
+      data = proximity;
+      send_frame(0x80, 0x0B, &data, 1);
+      stats.reports += 2;
+    }
+  }
+}
+
+/*
+Build frame to buffer of FRAME_SIZE bytes
+corrupt - wrong checksum, to test error handling
+Returns frame size, 0 if data does not fit
+*/
+size_t Radar_Simulator::build_frame(uint8_t *frame, uint8_t control_word,
+                                    uint8_t cmd_word, const uint8_t *data,
+                                    uint16_t len, bool corrupt) {
+  size_t size = len + FRAME_OVERHEAD;
+
+  if (size > FRAME_SIZE) {
+    return 0;
+  }
+
+  frame[I_HEAD1] = HEAD1;
+  frame[I_HEAD2] = HEAD2;
+  frame[I_CONTROL_WORD] = control_word;
+  frame[I_CMD_WORD] = cmd_word;
+  frame[I_LENGHT_H] = len >> 8;
+  frame[I_LENGHT_L] = len & 0xFF;
+  memcpy(frame + I_DATA, data, len);
+
+  uint8_t sum = 0;
+  for (size_t i = 0; i < size_t(I_DATA) + len; i++) {
+    sum += frame[i];
+  }
+
+  if (!corrupt && config.corrupt > 0
+      && (next_random() % 10000) < config.corrupt * 10000) {
+    corrupt = true;
+  }
+  if (corrupt) {
+    sum ^= 0x5A;
+    stats.corrupted++;
+  }
+
+  frame[I_DATA + len] = sum;
+  frame[I_DATA + len + 1] = END1;
+  frame[I_DATA + len + 2] = END2;
+
+  return size;
+}
+
+/*
+Build frame and write it to stream
+Returns frame size, 0 if data does not fit
+*/
+size_t Radar_Simulator::send_frame(uint8_t control_word, uint8_t cmd_word,
+                                   const uint8_t *data, uint16_t len,
+                                   bool corrupt) {
+  uint8_t frame[FRAME_SIZE];
+  size_t size = build_frame(frame, control_word, cmd_word, data, len, corrupt);
+
+  if (size > 0) {
+    stream->write(frame, size);
+    stats.bytes_sent += size;
+  }
+  return size;
+}
+
+/*
+Send response now or queue it for reply_delay_ms
+*/
+void Radar_Simulator::reply(uint8_t control_word, uint8_t cmd_word,
+                            const uint8_t *data, uint16_t len) {
+  if (config.reply_delay_ms == 0) {
+    if (send_frame(control_word, cmd_word, data, len) > 0) {
+      stats.replies++;
+    }
+    return;
+  }
+
+  if (replies_count >= SIM_REPLY_SLOTS) {
+    stats.dropped++;
+    return;
+  }
+
+  Reply &r = replies[replies_count];
+  r.len = build_frame(r.bytes, control_word, cmd_word, data, len, false);
+  if (r.len > 0) {
+    r.due = now + config.reply_delay_ms;
+    replies_count++;
+  }
+}
+
+void Radar_Simulator::reply_u8(uint8_t control_word, uint8_t cmd_word,
+                               uint8_t value) {
+  reply(control_word, cmd_word, &value, 1);
+}
+
+void Radar_Simulator::reply_u32(uint8_t control_word, uint8_t cmd_word,
+                                uint32_t value) {
+  uint8_t data[4] = {
+    static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16),
+    static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+  reply(control_word, cmd_word, data, sizeof(data));
+}
+
+void Radar_Simulator::reply_text(uint8_t control_word, uint8_t cmd_word,
+                                 const char *text) {
+  size_t len = strlen(text);
+  if (len > FRAME_SIZE - FRAME_OVERHEAD) {
+    len = FRAME_SIZE - FRAME_OVERHEAD;
+  }
+  reply(control_word, cmd_word, reinterpret_cast<const uint8_t *>(text), len);
+}
+
+/*
+xorshift32, same sequence for same seed
+*/
+uint32_t Radar_Simulator::next_random() {
+  uint32_t x = random_state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  random_state = x;
+  return x;
+}
+
+/*
+Value with random change up to noise * range
+*/
+int Radar_Simulator::noisy(int value, int range, int min, int max) {
+  int amplitude = static_cast<int>(config.noise * range);
+
+  if (amplitude > 0) {
+    value += static_cast<int>(next_random() % (2 * amplitude + 1)) - amplitude;
+  }
+
+  if (value < min) {
+    return min;
+  } else if (value > max) {
+    return max;
+  }
+  return value;
+}
+
+/*
+cm to 0.5 m steps
+*/
+uint8_t Radar_Simulator::distance_byte(int cm) {
+  return noisy((cm + 25) / 50, 10, 0, 0x0A);
+}
+
+/*
+m/s to speed byte: 0x0A is still, 0x01-0x09 positive, 0x0B-0x14 negative
+*/
+uint8_t Radar_Simulator::speed_byte(float speed) {
+  int steps = noisy(static_cast<int>(speed * 2 + (speed < 0 ? -0.5 : 0.5)),
+                    10, -10, 9);
+
+  if (steps == 0) {
+    return 0x0A;
+  } else if (steps > 0) {
+    return steps;
+  }
+  return 0x0A - steps;
+}
+
+#endif  // !ARDUINO
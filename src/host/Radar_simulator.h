@@ -0,0 +1,179 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_SRC_HOST_RADAR_SIMULATOR_H_
+#define LIB_RADAR_MR24HPC1_SRC_HOST_RADAR_SIMULATOR_H_
+
+/*
+MR24HPC1 device simulator for host builds.
+Answers the library queries and sends sensor reports, so parser
+throughput and query latency can be tested without real radar.
+Connect it with pty (Radar_PosixStream) or in memory (Radar_MemoryStream).
+*/
+
+#if !defined(ARDUINO)
+
+#include "../Radar_MR24HPC1.h"
+
+#ifndef SIM_REPLY_SLOTS
+#define SIM_REPLY_SLOTS 16  // Delayed replies waiting to be sent
+#endif
+
+/*
+In-memory byte pipe, two connected streams:
+  Radar_MemoryStream radar_side, device_side;
+  radar_side.connect(&device_side);
+Bytes written to one are read from the other.
+*/
+class Radar_MemoryStream : public Stream {
+ private:
+    Radar_MemoryStream *peer = nullptr;
+    uint8_t *rx_buffer = nullptr;
+    size_t rx_size = 0;  // Allocated bytes
+    size_t rx_pos = 0;   // Next byte to read
+    size_t rx_len = 0;   // Bytes in buffer
+
+    void receive(const uint8_t *buffer, size_t size);
+
+ public:
+    ~Radar_MemoryStream();
+
+    void connect(Radar_MemoryStream *other);
+    void clear();  // Drop unread bytes
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t read_bytes(uint8_t *buffer, size_t size);
+
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int availableForWrite() override;
+};
+
+/*
+What radar sees
+Distances in cm, speed in m/s
+Positive speed is approaching, as in 0x08 0x01 report
+*/
+struct Radar_SimScene {
+  int   presence = OCCUPIED;
+  int   motion = MOTION;
+  int   activity = 30;          // 0-100
+  int   static_energy = 60;     // 0-250
+  int   static_distance = 150;  // cm
+  int   motion_energy = 120;    // 0-250
+  int   motion_distance = 200;  // cm
+  float motion_speed = 0.5;     // m/s
+};
+
+struct Radar_SimConfig {
+  uint32_t sensor_report_ms = 1000;    // 0x08 0x01 in ADVANCED mode, 0 off
+  uint32_t presence_report_ms = 1000;  // 0x80 reports, 0 off
+  uint32_t heartbeat_ms = 0;           // 0x01 0x01, 0 off
+  uint32_t reply_delay_ms = 0;         // Query to response time
+  float    noise = 0;                  // 0-1, random change of scene values
+  float    corrupt = 0;                // 0-1, frames sent with bad checksum
+  uint32_t seed = 1;
+};
+
+// Simulator counters
+struct Radar_SimStats {
+  uint32_t queries;       // Good frames received
+  uint32_t unknown;       // Queries without answer
+  uint32_t bad_frames;    // Checksum or tail errors
+  uint32_t replies;       // Responses sent
+  uint32_t reports;       // Unsolicited reports sent
+  uint32_t corrupted;     // Frames sent with bad checksum
+  uint32_t dropped;       // Replies lost, reply slots full
+  uint32_t bytes_sent;
+};
+
+class Radar_Simulator {
+ private:
+    Stream *stream;  // Device side
+    Radar_SimConfig config;
+    Radar_SimScene scene;
+    Radar_SimStats stats = {0, 0, 0, 0, 0, 0, 0, 0};
+    uint32_t random_state;
+
+    // Query parser
+    uint8_t rx[FRAME_SIZE] = {0};
+    uint8_t rx_len = 0;
+    uint16_t rx_expected = 0;
+
+    // Delayed replies
+    struct Reply {
+      unsigned long due;  // ms
+      uint8_t len;
+      uint8_t bytes[FRAME_SIZE];
+    };
+    Reply replies[SIM_REPLY_SLOTS];
+    uint8_t replies_count = 0;
+
+    unsigned long now = 0;  // ms, from last run()
+    unsigned long next_sensor_report = 0;
+    unsigned long next_presence_report = 0;
+    unsigned long next_heartbeat = 0;
+
+    // Radar settings
+    int mode = SIMPLE;
+    int custom_mode = 0;
+    int scene_setting = 0x01;               // SIMPLE trigger limits
+    int sensitivity = 0x03;
+    int motion_limit = RANGE_400_CM;        // ADVANCED boundaries, 0.5 m steps
+    int static_limit = RANGE_300_CM;
+    int motion_threshold = 30;              // Energy thresholds
+    int static_threshold = 30;
+    uint32_t motion_trigger_time = 150;     // ms
+    uint32_t motion_to_static_time = 3000;  // ms
+    uint32_t no_person_time = 30000;        // ms, ADVANCED
+    int no_person_code = TIME_30_S;         // SIMPLE
+    int proximity = NONE;
+
+    const char *product_model = "MR24HPC1";
+    const char *product_id = "00000001";
+    const char *hardware_model = "G60SM1SYv010003";
+    const char *firmware_version = "G60SM1SYv010106";
+
+    void parse_byte(uint8_t byte);
+    void answer(const uint8_t *frame);
+    void send_reports();
+
+    size_t build_frame(uint8_t *frame, uint8_t control_word, uint8_t cmd_word,
+                       const uint8_t *data, uint16_t len, bool corrupt);
+    void reply(uint8_t control_word, uint8_t cmd_word,
+               const uint8_t *data, uint16_t len);
+    void reply_u8(uint8_t control_word, uint8_t cmd_word, uint8_t value);
+    void reply_u32(uint8_t control_word, uint8_t cmd_word, uint32_t value);
+    void reply_text(uint8_t control_word, uint8_t cmd_word, const char *text);
+
+    uint32_t next_random();
+    int noisy(int value, int range, int min, int max);
+    uint8_t distance_byte(int cm);
+    uint8_t speed_byte(float speed);
+
+ public:
+    explicit Radar_Simulator(Stream *s);
+
+    void set_config(const Radar_SimConfig &c);
+    void set_scene(const Radar_SimScene &s);
+    const Radar_SimScene &get_scene() const { return scene; }
+    int get_mode() const { return mode; }
+
+    void run(unsigned long now_ms);  // Answer queries, send due frames
+    void run() { run(millis()); }
+
+    // Send any frame now, also unknown or broken frames
+    size_t send_frame(uint8_t control_word, uint8_t cmd_word,
+                      const uint8_t *data, uint16_t len,
+                      bool corrupt = false);
+
+    const Radar_SimStats &get_stats() const { return stats; }
+};
+
+#endif  // !ARDUINO
+
+#endif  // LIB_RADAR_MR24HPC1_SRC_HOST_RADAR_SIMULATOR_H_
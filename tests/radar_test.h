@@ -0,0 +1,108 @@
+/*
+Copyright 2023 Tauno Erik
+*/
+
+#ifndef LIB_RADAR_MR24HPC1_TESTS_RADAR_TEST_H_
+#define LIB_RADAR_MR24HPC1_TESTS_RADAR_TEST_H_
+
+/*
+Minimal test helpers for host tests
+CHECK() reports a failed condition and continues,
+test_result() is the exit code of main().
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Radar_MR24HPC1.h"
+#include "host/Radar_simulator.h"
+
+static int test_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      test_failures++; \
+    } \
+  } while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long long va_ = static_cast<long long>(a); \
+    long long vb_ = static_cast<long long>(b); \
+    if (va_ != vb_) { \
+      printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", \
+             __FILE__, __LINE__, #a, #b, va_, vb_); \
+      test_failures++; \
+    } \
+  } while (0)
+
+#define CHECK_NEAR(a, b, eps) do { \
+    double va_ = (a); \
+    double vb_ = (b); \
+    if (va_ - vb_ > (eps) || vb_ - va_ > (eps)) { \
+      printf("%s:%d: CHECK_NEAR(%s, %s) failed: %g != %g\n", \
+             __FILE__, __LINE__, #a, #b, va_, vb_); \
+      test_failures++; \
+    } \
+  } while (0)
+
+static inline int test_result(const char *name) {
+  printf("%s: %s\n", name, test_failures == 0 ? "ok" : "FAILED");
+  return test_failures == 0 ? 0 : 1;
+}
+
+/*
+Radar frame with given data, checksum and tail
+Returns frame size
+*/
+static inline size_t test_frame(uint8_t *out, uint8_t control_word, uint8_t cmd_word,
+                         const uint8_t *data, uint8_t len) {
+  size_t n = 0;
+  out[n++] = HEAD1;
+  out[n++] = HEAD2;
+  out[n++] = control_word;
+  out[n++] = cmd_word;
+  out[n++] = 0x00;
+  out[n++] = len;
+  for (uint8_t i = 0; i < len; i++) {
+    out[n++] = data[i];
+  }
+
+  uint8_t sum = 0;
+  for (size_t i = 0; i < n; i++) {
+    sum += out[i];
+  }
+  out[n++] = sum;
+  out[n++] = END1;
+  out[n++] = END2;
+  return n;
+}
+
+/*
+Memory stream that counts writes, radar side of a pipe
+*/
+class TestStream : public Radar_MemoryStream {
+ public:
+    int writes = 0;
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+      writes++;
+      return Radar_MemoryStream::write(buffer, size);
+    }
+    using Radar_MemoryStream::write;
+};
+
+/*
+Run simulator and radar for ms milliseconds of simulated time
+now - simulated clock, advanced in 10 ms steps
+*/
+static inline void test_run(Radar_Simulator *sim, Radar_MR24HPC1 *radar,
+                     unsigned long &now, unsigned long ms) {
+  for (unsigned long end = now + ms; now < end; now += 10) {
+    sim->run(now);
+    radar->run();
+  }
+}
+
+#endif  // LIB_RADAR_MR24HPC1_TESTS_RADAR_TEST_H_
@@ -0,0 +1,137 @@
+/*
+Copyright 2023 Tauno Erik
+
+Query batches: one write per batch, full TX buffer is sent early
+*/
+
+#include "radar_test.h"
+
+/*
+Command words of query frames device got, in order
+Returns number of frames
+*/
+static int read_queries(Radar_MemoryStream *device, uint8_t *cmd_words,
+                        int max) {
+  uint8_t bytes[256];
+  size_t len = device->read_bytes(bytes, sizeof(bytes));
+  CHECK_EQ(len % QUERY_SIZE, 0);
+
+  int count = 0;
+  for (size_t i = 0; i + QUERY_SIZE <= len && count < max; i += QUERY_SIZE) {
+    CHECK_EQ(bytes[i], HEAD1);
+    CHECK_EQ(bytes[i + QUERY_SIZE - 1], END2);
+    cmd_words[count++] = bytes[i + I_CMD_WORD];
+  }
+  return count;
+}
+
+static void test_single() {
+  TestStream port;
+  Radar_MemoryStream device;
+  device.connect(&port);
+  Radar_MR24HPC1 radar(&port);
+
+  radar.ask_heartbeat();
+  radar.ask_presence();
+  radar.ask_motion();
+  CHECK_EQ(port.writes, 3);
+}
+
+static void test_batch() {
+  TestStream port;
+  Radar_MemoryStream device;
+  device.connect(&port);
+  Radar_MR24HPC1 radar(&port);
+
+  radar.begin_batch();
+  Radar_Request heartbeat = radar.ask_heartbeat();
+  radar.ask_presence();
+  radar.ask_motion();
+  radar.ask_activity();
+  CHECK_EQ(port.writes, 0);
+  CHECK_EQ(device.available(), 0);
+  CHECK_EQ(radar.get_request_status(heartbeat), REQUEST_PENDING);
+
+  radar.end_batch();
+  CHECK_EQ(port.writes, 1);
+
+  uint8_t cmd[8];
+  CHECK_EQ(read_queries(&device, cmd, 8), 4);
+  CHECK_EQ(cmd[0], 0x01);  // 0x01 0x01 heartbeat
+  CHECK_EQ(cmd[1], 0x81);  // 0x80 0x81 presence
+  CHECK_EQ(cmd[2], 0x82);
+  CHECK_EQ(cmd[3], 0x83);
+
+  // Empty batch writes nothing
+  radar.begin_batch();
+  radar.end_batch();
+  CHECK_EQ(port.writes, 1);
+}
+
+/*
+Only outermost end_batch() writes, extra end_batch() does nothing
+*/
+static void test_nested() {
+  TestStream port;
+  Radar_MemoryStream device;
+  device.connect(&port);
+  Radar_MR24HPC1 radar(&port);
+
+  radar.begin_batch();
+  radar.ask_heartbeat();
+  radar.ask_device_info();  // Own batch inside
+  CHECK_EQ(port.writes, 0);
+  radar.end_batch();
+  CHECK_EQ(port.writes, 1);
+
+  uint8_t cmd[8];
+  CHECK_EQ(read_queries(&device, cmd, 8), 5);
+
+  radar.end_batch();
+  radar.ask_presence();
+  CHECK_EQ(port.writes, 2);
+}
+
+/*
+Queries that don't fit TX_BUFFER_SIZE: buffer is written first,
+no frame is split or lost
+*/
+static void test_overflow() {
+  TestStream port;
+  Radar_MemoryStream device;
+  device.connect(&port);
+  Radar_MR24HPC1 radar(&port);
+
+  static_assert(TX_BUFFER_SIZE / QUERY_SIZE == 6, "Test sends 7 queries");
+
+  radar.begin_batch();
+  radar.ask_heartbeat();
+  radar.ask_presence();
+  radar.ask_motion();
+  radar.ask_activity();
+  radar.ask_direction();
+  radar.ask_product_model();
+  CHECK_EQ(port.writes, 0);
+
+  radar.ask_product_id();  // Does not fit
+  CHECK_EQ(port.writes, 1);
+  CHECK_EQ(device.available(), 6 * QUERY_SIZE);
+
+  radar.end_batch();
+  CHECK_EQ(port.writes, 2);
+
+  uint8_t cmd[8];
+  CHECK_EQ(read_queries(&device, cmd, 8), 7);
+  CHECK_EQ(cmd[0], 0x01);
+  CHECK_EQ(cmd[5], 0xA1);
+  CHECK_EQ(cmd[6], 0xA2);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_single();
+  test_batch();
+  test_nested();
+  test_overflow();
+  return test_result("test_batch");
+}
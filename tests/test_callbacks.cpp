@@ -0,0 +1,189 @@
+/*
+Copyright 2023 Tauno Erik
+
+Event callbacks: each report calls its callback once with decoded value,
+nullptr unregisters
+*/
+
+#include "radar_test.h"
+
+// Calls and last value of one callback
+struct Calls {
+  int count;
+  int value;
+};
+
+static Calls presence_calls;
+static Calls motion_calls;
+static Calls activity_calls;
+static Calls direction_calls;
+static Calls heartbeat_calls;
+static Calls report_calls;
+static Radar_SensorReport last_report;
+
+static void add_call(Calls &calls, int value) {
+  calls.count++;
+  calls.value = value;
+}
+
+static void on_presence(Radar_MR24HPC1 *, int value) {
+  add_call(presence_calls, value);
+}
+
+static void on_motion(Radar_MR24HPC1 *, int value) {
+  add_call(motion_calls, value);
+}
+
+static void on_activity(Radar_MR24HPC1 *, int value) {
+  add_call(activity_calls, value);
+}
+
+static void on_direction(Radar_MR24HPC1 *, int value) {
+  add_call(direction_calls, value);
+}
+
+static void on_heartbeat(Radar_MR24HPC1 *, int value) {
+  add_call(heartbeat_calls, value);
+}
+
+static void on_report(Radar_MR24HPC1 *, const Radar_SensorReport &report) {
+  add_call(report_calls, report.motion_energy);
+  last_report = report;
+}
+
+static void clear_calls() {
+  presence_calls = Calls();
+  motion_calls = Calls();
+  activity_calls = Calls();
+  direction_calls = Calls();
+  heartbeat_calls = Calls();
+  report_calls = Calls();
+}
+
+static void feed(Radar_MR24HPC1 *radar, uint8_t cw, uint8_t cmd,
+                 const uint8_t *data, uint8_t len) {
+  uint8_t frame[FRAME_SIZE];
+  size_t n = test_frame(frame, cw, cmd, data, len);
+  radar->feed(frame, n);
+  radar->run();
+}
+
+static void feed_u8(Radar_MR24HPC1 *radar, uint8_t cw, uint8_t cmd,
+                    uint8_t value) {
+  feed(radar, cw, cmd, &value, 1);
+}
+
+static void register_all(Radar_MR24HPC1 *radar) {
+  radar->on_presence(on_presence);
+  radar->on_motion(on_motion);
+  radar->on_activity(on_activity);
+  radar->on_direction(on_direction);
+  radar->on_heartbeat(on_heartbeat);
+  radar->on_sensor_report(on_report);
+}
+
+static void test_reports() {
+  Radar_MemoryStream port;
+  Radar_MR24HPC1 radar(&port);
+  register_all(&radar);
+  clear_calls();
+
+  feed_u8(&radar, 0x80, 0x01, OCCUPIED);
+  CHECK_EQ(presence_calls.count, 1);
+  CHECK_EQ(presence_calls.value, OCCUPIED);
+
+  feed_u8(&radar, 0x80, 0x02, ACTIVE);
+  CHECK_EQ(motion_calls.count, 1);
+  CHECK_EQ(motion_calls.value, ACTIVE);
+
+  feed_u8(&radar, 0x80, 0x03, 42);
+  CHECK_EQ(activity_calls.count, 1);
+  CHECK_EQ(activity_calls.value, 42);
+
+  feed_u8(&radar, 0x80, 0x0B, RECEDING);
+  CHECK_EQ(direction_calls.count, 1);
+  CHECK_EQ(direction_calls.value, RECEDING);
+
+  feed(&radar, 0x01, 0x01, nullptr, 0);
+  feed(&radar, 0x01, 0x01, nullptr, 0);
+  CHECK_EQ(heartbeat_calls.count, 2);
+  CHECK_EQ(heartbeat_calls.value, 2);  // Counter
+
+  // Distances 1.0 m and 2.0 m, speed byte 0x0C is 1.0 m/s receding
+  uint8_t data[5] = {120, 0x02, 60, 0x04, 0x0C};
+  feed(&radar, 0x08, 0x01, data, sizeof(data));
+  CHECK_EQ(report_calls.count, 1);
+  CHECK_EQ(last_report.static_energy, 120);
+  CHECK_EQ(last_report.static_distance, 100);
+  CHECK_EQ(last_report.motion_energy, 60);
+  CHECK_EQ(last_report.motion_distance, 200);
+  CHECK_NEAR(last_report.motion_speed, -1.0, 1e-6);
+  CHECK_EQ(last_report.direction, RECEDING);
+
+  // No other callback was called
+  CHECK_EQ(presence_calls.count, 1);
+  CHECK_EQ(motion_calls.count, 1);
+  CHECK_EQ(activity_calls.count, 1);
+  CHECK_EQ(direction_calls.count, 1);
+}
+
+/*
+Inquiry responses call the same callbacks
+*/
+static void test_responses() {
+  Radar_MemoryStream port;
+  Radar_MR24HPC1 radar(&port);
+  register_all(&radar);
+  clear_calls();
+
+  feed_u8(&radar, 0x80, 0x81, UNOCCUPIED);
+  feed_u8(&radar, 0x80, 0x82, STATIC);
+  feed_u8(&radar, 0x80, 0x83, 7);
+  feed_u8(&radar, 0x80, 0x8B, APPROACHING);
+
+  CHECK_EQ(presence_calls.count, 1);
+  CHECK_EQ(presence_calls.value, UNOCCUPIED);
+  CHECK_EQ(motion_calls.value, STATIC);
+  CHECK_EQ(activity_calls.value, 7);
+  CHECK_EQ(direction_calls.value, APPROACHING);
+}
+
+static void test_unregister() {
+  Radar_MemoryStream port;
+  Radar_MR24HPC1 radar(&port);
+  register_all(&radar);
+
+  radar.on_presence(nullptr);
+  radar.on_motion(nullptr);
+  radar.on_activity(nullptr);
+  radar.on_direction(nullptr);
+  radar.on_heartbeat(nullptr);
+  radar.on_sensor_report(nullptr);
+  clear_calls();
+
+  feed_u8(&radar, 0x80, 0x01, OCCUPIED);
+  feed_u8(&radar, 0x80, 0x02, ACTIVE);
+  feed_u8(&radar, 0x80, 0x03, 42);
+  feed_u8(&radar, 0x80, 0x0B, RECEDING);
+  feed(&radar, 0x01, 0x01, nullptr, 0);
+  uint8_t data[5] = {120, 0x02, 60, 0x04, 0x0C};
+  feed(&radar, 0x08, 0x01, data, sizeof(data));
+
+  CHECK_EQ(presence_calls.count + motion_calls.count + activity_calls.count
+           + direction_calls.count + heartbeat_calls.count
+           + report_calls.count, 0);
+
+  // State is still decoded
+  Radar_State state;
+  radar.get_state(state);
+  CHECK_EQ(state.presence, OCCUPIED);
+  CHECK_EQ(state.motion, ACTIVE);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_reports();
+  test_responses();
+  test_unregister();
+  return test_result("test_callbacks");
+}
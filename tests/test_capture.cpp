@@ -0,0 +1,242 @@
+/*
+Copyright 2023 Tauno Erik
+
+Capture and replay: raw capture repeats parser errors
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "host/Radar_replay.h"
+#include "radar_test.h"
+
+#define REPORTS_MS 20000  // Simulated time
+
+// What a radar made of its input
+struct Result {
+  Radar_Counters counters;
+  Radar_State state;
+  uint32_t resyncs;
+  uint32_t discarded;
+};
+
+static void get_result(Radar_MR24HPC1 *radar, Result &result) {
+  radar->get_state(result.state);
+  result.resyncs = radar->get_resyncs();
+  result.discarded = radar->get_discarded_bytes();
+}
+
+/*
+Record simulator with broken frames
+*/
+static void make_capture(const char *path, bool raw, Result &live) {
+  Radar_FilePrint file;
+  CHECK(file.open(path));
+
+  Radar_MemoryStream sim_port;
+  Radar_MemoryStream radar_port;
+  sim_port.connect(&radar_port);
+
+  Radar_SimConfig config;
+  config.sensor_report_ms = 50;
+  config.presence_report_ms = 70;
+  config.noise = 0.1f;
+  config.corrupt = 0.05f;
+  Radar_Simulator sim(&sim_port);
+  sim.set_config(config);
+
+  Radar_Recorder recorder;
+  recorder.begin(&file);
+  recorder.set_raw(raw);
+
+  Radar_MR24HPC1 radar(&radar_port);
+  radar.set_recorder(&recorder);
+  radar.set_counters(&live.counters);
+
+  unsigned long now = 0;
+  test_run(&sim, &radar, now, REPORTS_MS);
+  get_result(&radar, live);
+
+  recorder.end();
+  CHECK_EQ(recorder.get_lost(), 0);
+  CHECK(sim.get_stats().corrupted > 0);
+}
+
+static void replay_capture(const char *path, Result &replayed) {
+  Radar_Replay replay;
+  CHECK(replay.open(path));
+
+  Radar_MemoryStream port;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&replayed.counters);
+  CHECK(replay.play(&radar) > 0);
+  get_result(&radar, replayed);
+}
+
+static void check_state(const Radar_State &a, const Radar_State &b) {
+  CHECK_EQ(a.presence, b.presence);
+  CHECK_EQ(a.motion, b.motion);
+  CHECK_EQ(a.static_energy, b.static_energy);
+  CHECK_EQ(a.static_distance, b.static_distance);
+  CHECK_EQ(a.motion_energy, b.motion_energy);
+  CHECK_EQ(a.motion_distance, b.motion_distance);
+  CHECK_NEAR(a.motion_speed, b.motion_speed, 1e-6);
+}
+
+static void test_raw(const char *path) {
+  Result live;
+  Result replayed;
+  make_capture(path, true, live);
+  replay_capture(path, replayed);
+
+  const Radar_Counters &a = live.counters;
+  const Radar_Counters &b = replayed.counters;
+  CHECK(a.get_checksum_errors() > 0);
+  CHECK_EQ(b.get_bytes(), a.get_bytes());
+  CHECK_EQ(b.get_frames(), a.get_frames());
+  CHECK_EQ(b.get_checksum_errors(), a.get_checksum_errors());
+  CHECK_EQ(b.get_truncated(), a.get_truncated());
+  CHECK_EQ(replayed.resyncs, live.resyncs);
+  CHECK_EQ(replayed.discarded, live.discarded);
+  check_state(live.state, replayed.state);
+}
+
+/*
+Frame capture has only good frames
+*/
+static void test_frames(const char *path) {
+  Result live;
+  Result replayed;
+  make_capture(path, false, live);
+  replay_capture(path, replayed);
+
+  CHECK_EQ(replayed.counters.get_frames(), live.counters.get_frames());
+  CHECK_EQ(replayed.counters.get_checksum_errors(), 0);
+  CHECK_EQ(replayed.resyncs, 0);
+  check_state(live.state, replayed.state);
+}
+
+/*
+Replay into radar with live stream does not read it
+*/
+static void test_live_stream(const char *path) {
+  Result live;
+  make_capture(path, false, live);
+
+  Radar_MemoryStream device;
+  Radar_MemoryStream port;
+  device.connect(&port);
+
+  uint8_t motion = ACTIVE;
+  uint8_t frame[FRAME_SIZE];
+  size_t len = test_frame(frame, 0x80, 0x02, &motion, 1);
+  device.write(frame, len);
+
+  Radar_Replay replay;
+  CHECK(replay.open(path));
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+  CHECK(replay.play(&radar) > 0);
+
+  CHECK_EQ(counters.get_frames(), live.counters.get_frames());
+  CHECK_EQ(port.available(), len);
+}
+
+/*
+Unknown format version is not opened
+*/
+static void test_version(const char *path) {
+  FILE *file = fopen(path, "wb");
+  CHECK(file != nullptr);
+  const uint8_t header[CAPTURE_HEADER_SIZE] = {
+    'R', 'C', 'A', 'P', CAPTURE_VERSION + 1, CAPTURE_RECORD_HEADER, 0, 0};
+  fwrite(header, 1, sizeof(header), file);
+  fclose(file);
+
+  Radar_Replay replay;
+  CHECK(!replay.open(path));
+}
+
+/*
+Print that takes limited bytes, tells room if asked
+*/
+class LimitedPrint : public Print {
+ public:
+    size_t size = 0;
+    size_t limit = 0;
+    bool tells_room = false;
+
+    size_t write(uint8_t byte) override {
+      if (size >= limit) {
+        return 0;
+      }
+      size++;
+      return 1;
+    }
+    using Print::write;
+
+    int availableForWrite() override {
+      return tells_room ? static_cast<int>(limit - size) : 0;
+    }
+};
+
+/*
+Records are written whole or not at all
+*/
+static void test_short_write() {
+  uint8_t frame[FRAME_SIZE];
+  uint8_t value = 1;
+  size_t len = test_frame(frame, 0x80, 0x01, &value, 1);
+  size_t record = CAPTURE_RECORD_HEADER + len;
+
+  // Room is known: record that does not fit is skipped
+  LimitedPrint out;
+  out.tells_room = true;
+  out.limit = CAPTURE_HEADER_SIZE + record + record / 2;
+  Radar_Recorder recorder;
+  CHECK(recorder.begin(&out));
+  recorder.record(frame, len, CAPTURE_RX);
+  recorder.record(frame, len, CAPTURE_RX);
+  CHECK_EQ(recorder.get_records(), 1);
+  CHECK_EQ(recorder.get_lost(), 1);
+  CHECK(!recorder.is_failed());
+  CHECK_EQ(out.size, CAPTURE_HEADER_SIZE + record);
+
+  out.limit += record;
+  recorder.record(frame, len, CAPTURE_RX);
+  CHECK_EQ(recorder.get_records(), 2);
+
+  // Room is not known: short write stops recording
+  LimitedPrint blind;
+  blind.limit = CAPTURE_HEADER_SIZE + record + record / 2;
+  CHECK(recorder.begin(&blind));
+  recorder.record(frame, len, CAPTURE_RX);
+  recorder.record(frame, len, CAPTURE_RX);
+  CHECK(recorder.is_failed());
+  size_t size = blind.size;
+
+  blind.limit += 10 * record;
+  recorder.record(frame, len, CAPTURE_RX);
+  CHECK_EQ(blind.size, size);
+  CHECK_EQ(recorder.get_records(), 1);
+  CHECK_EQ(recorder.get_lost(), 2);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+
+  char path[] = "/tmp/test_capture_XXXXXX";
+  int fd = mkstemp(path);
+  CHECK(fd >= 0);
+  close(fd);
+
+  test_raw(path);
+  test_frames(path);
+  test_live_stream(path);
+  test_version(path);
+  test_short_write();
+
+  unlink(path);
+  return test_result("test_capture");
+}
@@ -0,0 +1,133 @@
+/*
+Copyright 2023 Tauno Erik
+
+Receive and dispatch counters, reset between and inside feeds
+*/
+
+#include "radar_test.h"
+
+static size_t activity_frame(uint8_t *out, uint8_t value) {
+  return test_frame(out, 0x80, 0x03, &value, 1);
+}
+
+static void test_counts() {
+  Radar_MemoryStream port;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+
+  uint8_t buffer[64];
+  size_t n = activity_frame(buffer, 1);
+  buffer[n - 3]++;  // Checksum
+  n += activity_frame(&buffer[n], 2);
+  n += test_frame(&buffer[n], 0x7E, 0x01, nullptr, 0);  // No handler
+
+  radar.feed(buffer, n);
+  radar.run();
+
+  CHECK_EQ(counters.get_bytes(), n);
+  CHECK_EQ(counters.get_frames(), 2);
+  CHECK_EQ(counters.get_checksum_errors(), 1);
+  CHECK_EQ(counters.get_truncated(), 0);
+  CHECK_EQ(counters.get_command_frames(0x80, 0x03), 1);
+  CHECK_EQ(counters.get_runs(), 1);
+
+  uint8_t cw, cmd;
+  counters.get_last_unknown(cw, cmd);
+  CHECK_EQ(cw, 0x7E);
+  CHECK_EQ(cmd, 0x01);
+
+  CHECK_EQ(counters.get_unknown(), 1);
+  CHECK_EQ(counters.get_resyncs(), 1);
+  CHECK_EQ(counters.get_discarded(), FRAME_OVERHEAD + 1);
+
+  // Radar getters read the same counters
+  CHECK_EQ(radar.get_unknown_frames(), 1);
+  CHECK_EQ(radar.get_resyncs(), 1);
+  CHECK_EQ(radar.get_discarded_bytes(), FRAME_OVERHEAD + 1);
+}
+
+/*
+Reset clears everything, also histogram words and last unknown pair
+*/
+static void test_reset() {
+  Radar_MemoryStream port;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+
+  uint8_t buffer[64];
+  size_t n = activity_frame(buffer, 1);
+  n += test_frame(&buffer[n], 0x7E, 0x01, nullptr, 0);
+  radar.feed(buffer, n);
+  radar.run();
+
+  counters.reset();
+
+  // Bad frame only: first update after reset is a checksum error
+  n = activity_frame(buffer, 1);
+  buffer[n - 3]++;
+  radar.feed(buffer, n);
+  radar.run();
+
+  CHECK_EQ(counters.get_bytes(), n);
+  CHECK_EQ(counters.get_frames(), 0);
+  CHECK_EQ(counters.get_checksum_errors(), 1);
+  CHECK_EQ(counters.get_runs(), 0);
+  CHECK_EQ(counters.get_unknown(), 0);
+  CHECK_EQ(counters.get_resyncs(), 0);  // Next good frame counts it
+  CHECK_EQ(counters.get_discarded(), 0);
+
+  uint8_t cw = 0xFF;
+  uint8_t cmd = 0xFF;
+  counters.get_last_unknown(cw, cmd);
+  CHECK_EQ(cw, 0);
+  CHECK_EQ(cmd, 0);
+
+  for (uint8_t i = 0; i < COUNTER_COMMANDS; i++) {
+    cw = 0xFF;
+    cmd = 0xFF;
+    CHECK_EQ(counters.get_command(i, cw, cmd), 0);
+    CHECK_EQ(cw, 0);
+    CHECK_EQ(cmd, 0);
+  }
+}
+
+/*
+Errors found in a feed before its byte count are not lost by reset
+*/
+static void test_reset_in_feed() {
+  Radar_MemoryStream port;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+
+  uint8_t buffer[64];
+  size_t n = activity_frame(buffer, 1);
+  radar.feed(buffer, n);
+  radar.run();
+  CHECK_EQ(counters.get_frames(), 1);
+
+  counters.reset();
+
+  n = activity_frame(buffer, 1);
+  buffer[n - 3]++;
+  n += activity_frame(&buffer[n], 2);
+  radar.feed(buffer, n);
+  radar.run();
+
+  CHECK_EQ(counters.get_bytes(), n);
+  CHECK_EQ(counters.get_frames(), 1);
+  CHECK_EQ(counters.get_checksum_errors(), 1);
+  CHECK_EQ(counters.get_command_frames(0x80, 0x03), 1);
+  CHECK_EQ(counters.get_runs(), 1);
+  CHECK_EQ(counters.get_resyncs(), 1);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_counts();
+  test_reset();
+  test_reset_in_feed();
+  return test_result("test_counters");
+}
@@ -0,0 +1,123 @@
+/*
+Copyright 2023 Tauno Erik
+
+Deadband: only changed sensor reports are published
+*/
+
+#include "radar_test.h"
+
+static Radar_SensorReport last_report;
+static int reports = 0;
+
+static void on_report(Radar_MR24HPC1 *, const Radar_SensorReport &report) {
+  last_report = report;
+  reports++;
+}
+
+static void test_update() {
+  Radar_Deadband deadband;
+  deadband.set_energy(5);
+  deadband.set_distance(50);
+  deadband.set_speed(0.5f);
+
+  // First report is published whole
+  CHECK_EQ(deadband.update(100, 200, 50, 150, 0, NONE), REPORT_ALL);
+
+  // Inside deadband
+  CHECK_EQ(deadband.update(104, 240, 46, 150, 0.4f, NONE), 0);
+
+  // Each field on its own
+  CHECK_EQ(deadband.update(105, 200, 50, 150, 0, NONE), REPORT_STATIC_ENERGY);
+  CHECK_EQ(deadband.update(105, 250, 50, 150, 0, NONE),
+           REPORT_STATIC_DISTANCE);
+  CHECK_EQ(deadband.update(105, 250, 40, 150, 0, NONE), REPORT_MOTION_ENERGY);
+  CHECK_EQ(deadband.update(105, 250, 40, 100, 0, NONE),
+           REPORT_MOTION_DISTANCE);
+  CHECK_EQ(deadband.update(105, 250, 40, 100, -0.5f, NONE),
+           REPORT_MOTION_SPEED);
+  CHECK_EQ(deadband.update(105, 250, 40, 100, -0.5f, RECEDING),
+           REPORT_DIRECTION);
+
+  CHECK_EQ(deadband.get_reports(), 8);
+  CHECK_EQ(deadband.get_suppressed(), 1);
+}
+
+/*
+Drift is compared with published value, so it is published when it adds up
+*/
+static void test_drift() {
+  Radar_Deadband deadband;
+  deadband.set_energy(5);
+
+  CHECK_EQ(deadband.update(100, 0, 0, 0, 0, NONE), REPORT_ALL);
+  for (int e = 101; e < 105; e++) {
+    CHECK_EQ(deadband.update(e, 0, 0, 0, 0, NONE), 0);
+  }
+  CHECK_EQ(deadband.update(105, 0, 0, 0, 0, NONE), REPORT_STATIC_ENERGY);
+}
+
+static void test_zero_band() {
+  Radar_Deadband deadband;
+  deadband.set_static(0, 0);
+  deadband.set_motion(0, 0);
+  deadband.set_speed(0);
+
+  deadband.update(1, 1, 1, 1, 0, NONE);
+  CHECK_EQ(deadband.update(1, 1, 1, 1, 0, NONE), 0);  // Same is not change
+  CHECK_EQ(deadband.update(2, 1, 1, 1, 0, NONE), REPORT_STATIC_ENERGY);
+
+  deadband.reset();
+  CHECK_EQ(deadband.update(2, 1, 1, 1, 0, NONE), REPORT_ALL);
+}
+
+static void feed_report(Radar_MR24HPC1 *radar, uint8_t static_energy,
+                        uint8_t motion_energy) {
+  // Distances 1.0 m and 1.5 m, speed 0
+  uint8_t data[5] = {static_energy, 0x02, motion_energy, 0x03, 0x0A};
+  uint8_t frame[FRAME_SIZE];
+  size_t len = test_frame(frame, 0x08, 0x01, data, sizeof(data));
+  radar->feed(frame, len);
+  radar->run();
+}
+
+static void test_radar() {
+  Radar_MemoryStream port;
+  Radar_Deadband deadband;
+  Radar_MR24HPC1 radar(&port);
+  radar.on_sensor_report(on_report);
+  reports = 0;
+
+  // Without deadband every report is published
+  feed_report(&radar, 100, 50);
+  feed_report(&radar, 100, 50);
+  CHECK_EQ(reports, 2);
+  CHECK_EQ(last_report.changed, REPORT_ALL);
+
+  radar.set_deadband(&deadband);
+  reports = 0;
+  feed_report(&radar, 100, 50);
+  CHECK_EQ(reports, 1);
+  CHECK_EQ(last_report.changed, REPORT_ALL);
+
+  feed_report(&radar, 102, 50);
+  CHECK_EQ(reports, 1);
+
+  feed_report(&radar, 102, 60);
+  CHECK_EQ(reports, 2);
+  CHECK_EQ(last_report.changed, REPORT_MOTION_ENERGY);
+  CHECK_EQ(last_report.motion_energy, 60);
+  CHECK_EQ(deadband.get_suppressed(), 1);
+
+  // State is updated also when report is not published
+  feed_report(&radar, 103, 60);
+  CHECK_EQ(radar.get_static_energy(), 103);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_update();
+  test_drift();
+  test_zero_band();
+  test_radar();
+  return test_result("test_deadband");
+}
@@ -0,0 +1,156 @@
+/*
+Copyright 2023 Tauno Erik
+
+Radar_History: window edges, full ring, millis() wrap and every field
+*/
+
+#include "radar_test.h"
+
+static void add_energy(Radar_History *history, uint32_t time, int energy) {
+  history->add_report(time, energy, 0, 0, 0, 0);
+}
+
+static void test_window() {
+  Radar_History history;
+  Radar_HistoryStats stats;
+  CHECK_EQ(history.get_stats(HISTORY_STATIC_ENERGY, 1000, 0, stats), 0);
+
+  add_energy(&history, 1000, 10);
+  add_energy(&history, 2000, 20);
+  add_energy(&history, 3000, 30);
+
+  // Entry exactly window_ms old is inside
+  CHECK_EQ(history.get_stats(HISTORY_STATIC_ENERGY, 1000, 3000, stats), 2);
+  CHECK_NEAR(stats.min, 20, 1e-6);
+  CHECK_EQ(history.get_stats(HISTORY_STATIC_ENERGY, 999, 3000, stats), 1);
+  CHECK_EQ(history.get_stats(HISTORY_STATIC_ENERGY, 2000, 3000, stats), 3);
+  CHECK_EQ(history.get_stats(HISTORY_STATIC_ENERGY, 0, 3000, stats), 1);
+  CHECK_EQ(history.get_stats(HISTORY_STATIC_ENERGY, 500, 3600, stats), 0);
+}
+
+static void test_full() {
+  Radar_History history;
+  Radar_HistoryStats stats;
+
+  for (int i = 0; i < HISTORY_REPORTS + 3; i++) {
+    add_energy(&history, i, i);
+  }
+  CHECK_EQ(history.get_reports_count(), HISTORY_REPORTS);
+  CHECK_EQ(history.get_report(0).static_energy, HISTORY_REPORTS + 2);
+  CHECK_EQ(history.get_report(HISTORY_REPORTS - 1).static_energy, 3);
+
+  CHECK_EQ(history.get_stats(HISTORY_STATIC_ENERGY, 100000,
+                             HISTORY_REPORTS + 2, stats), HISTORY_REPORTS);
+  CHECK_NEAR(stats.min, 3, 1e-6);
+  CHECK_NEAR(stats.max, HISTORY_REPORTS + 2, 1e-6);
+
+  for (int i = 0; i < HISTORY_EVENTS + 1; i++) {
+    history.add_event(i, HISTORY_PRESENCE, i % 2);
+  }
+  CHECK_EQ(history.get_events_count(), HISTORY_EVENTS);
+  CHECK_EQ(history.get_event(0).time, HISTORY_EVENTS);
+  CHECK_EQ(history.get_event(HISTORY_EVENTS - 1).time, 1);
+
+  history.clear();
+  CHECK_EQ(history.get_reports_count(), 0);
+  CHECK_EQ(history.get_events_count(), 0);
+}
+
+static void test_wrap() {
+  Radar_History history;
+  Radar_HistoryStats stats;
+  uint32_t base = 0xFFFFFF00;
+
+  add_energy(&history, base, 10);
+  add_energy(&history, base + 0x80, 20);
+  add_energy(&history, base + 0x100, 30);  // 0 after wrap
+
+  CHECK_EQ(history.get_stats(HISTORY_STATIC_ENERGY, 0x100, 0x50, stats), 2);
+  CHECK_NEAR(stats.mean, 25, 1e-6);
+  CHECK_EQ(history.get_stats(HISTORY_STATIC_ENERGY, 0x150, 0x50, stats), 3);
+}
+
+static void test_fields() {
+  Radar_History history;
+  Radar_HistoryStats stats;
+
+  history.add_report(100, 10, 100, 40, 200, -0.5f);
+  history.add_report(200, 30, 150, 60, 300, 1.0f);
+
+  CHECK_EQ(history.get_stats(HISTORY_STATIC_ENERGY, 1000, 200, stats), 2);
+  CHECK_NEAR(stats.min, 10, 1e-6);
+  CHECK_NEAR(stats.max, 30, 1e-6);
+  CHECK_NEAR(stats.mean, 20, 1e-6);
+
+  history.get_stats(HISTORY_STATIC_DISTANCE, 1000, 200, stats);
+  CHECK_NEAR(stats.mean, 125, 1e-6);
+
+  history.get_stats(HISTORY_MOTION_ENERGY, 1000, 200, stats);
+  CHECK_NEAR(stats.min, 40, 1e-6);
+  CHECK_NEAR(stats.max, 60, 1e-6);
+
+  history.get_stats(HISTORY_MOTION_DISTANCE, 1000, 200, stats);
+  CHECK_NEAR(stats.max, 300, 1e-6);
+
+  history.get_stats(HISTORY_MOTION_SPEED, 1000, 200, stats);
+  CHECK_NEAR(stats.min, -0.5f, 1e-6);
+  CHECK_NEAR(stats.max, 1.0f, 1e-6);
+  CHECK_NEAR(stats.mean, 0.25f, 1e-6);
+
+  // Events of one field only
+  history.add_event(100, HISTORY_PRESENCE, OCCUPIED);
+  history.add_event(150, HISTORY_MOTION, ACTIVE);
+  history.add_event(200, HISTORY_PRESENCE, UNOCCUPIED);
+
+  CHECK_EQ(history.get_stats(HISTORY_PRESENCE, 1000, 200, stats), 2);
+  CHECK_NEAR(stats.mean, 0.5f, 1e-6);
+  CHECK_EQ(history.get_stats(HISTORY_MOTION, 1000, 200, stats), 1);
+  CHECK_NEAR(stats.max, ACTIVE, 1e-6);
+}
+
+static void feed(Radar_MR24HPC1 *radar, uint8_t cw, uint8_t cmd,
+                 uint8_t value) {
+  uint8_t frame[FRAME_SIZE];
+  size_t len = test_frame(frame, cw, cmd, &value, 1);
+  radar->feed(frame, len);
+  radar->run();
+}
+
+/*
+Reports and inquiry responses are both events
+*/
+static void test_radar() {
+  Radar_MemoryStream port;
+  Radar_History history;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_history(&history);
+
+  feed(&radar, 0x80, 0x01, OCCUPIED);
+  feed(&radar, 0x80, 0x81, UNOCCUPIED);
+  feed(&radar, 0x80, 0x02, STATIC);
+  feed(&radar, 0x80, 0x82, ACTIVE);
+
+  CHECK_EQ(history.get_events_count(), 4);
+  CHECK_EQ(history.get_event(2).field, HISTORY_PRESENCE);
+  CHECK_EQ(history.get_event(2).value, UNOCCUPIED);
+  CHECK_EQ(history.get_event(0).field, HISTORY_MOTION);
+  CHECK_EQ(history.get_event(0).value, ACTIVE);
+
+  uint8_t data[5] = {100, 0x02, 50, 0x03, 0x0A};
+  uint8_t frame[FRAME_SIZE];
+  size_t len = test_frame(frame, 0x08, 0x01, data, sizeof(data));
+  radar.feed(frame, len);
+  radar.run();
+  CHECK_EQ(history.get_reports_count(), 1);
+  CHECK_EQ(history.get_report(0).static_energy, 100);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_window();
+  test_full();
+  test_wrap();
+  test_fields();
+  test_radar();
+  return test_result("test_history");
+}
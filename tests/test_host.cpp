@@ -0,0 +1,73 @@
+/*
+Copyright 2023 Tauno Erik
+
+Host platform layer: pseudo-terminal stream and log sink
+*/
+
+#include <string>
+
+#include "radar_test.h"
+
+static std::string log_text;
+
+static void log_sink(const char *text, size_t len) {
+  log_text.append(text, len);
+}
+
+static int presence_of(Radar_MR24HPC1 *radar) {
+  Radar_State state;
+  radar->get_state(state);
+  return state.presence;
+}
+
+static void test_pty() {
+  Radar_PosixStream port;
+  char slave_path[64];
+  CHECK(port.open_pty(slave_path, sizeof(slave_path)));
+
+  Radar_PosixStream device;
+  CHECK(device.open(slave_path));
+
+  Radar_MR24HPC1 radar(&port);
+
+  uint8_t occupied = OCCUPIED;
+  uint8_t frame[FRAME_SIZE];
+  size_t len = test_frame(frame, 0x80, 0x01, &occupied, 1);
+  CHECK_EQ(device.write(frame, len), len);
+
+  unsigned long start = millis();
+  while (presence_of(&radar) != OCCUPIED
+         && millis() - start < 1000) {
+    radar.run();
+  }
+  CHECK_EQ(presence_of(&radar), OCCUPIED);
+
+  // Query from radar arrives at device
+  radar.ask_heartbeat();
+  uint8_t query[QUERY_SIZE];
+  size_t got = 0;
+  start = millis();
+  while (got < sizeof(query) && millis() - start < 1000) {
+    got += device.read_bytes(query + got, sizeof(query) - got);
+  }
+  CHECK_EQ(got, QUERY_SIZE);
+  CHECK_EQ(query[2], 0x01);
+  CHECK_EQ(query[3], 0x01);
+}
+
+static void test_log_sink() {
+  radar_set_log_sink(log_sink);
+  Serial.print("Presence ");
+  Serial.println(1);
+  CHECK(log_text == "Presence 1\r\n");
+
+  radar_set_log_sink(nullptr);
+  Serial.println("dropped");
+  CHECK(log_text.find("dropped") == std::string::npos);
+}
+
+int main() {
+  test_pty();
+  test_log_sink();
+  return test_result("test_host");
+}
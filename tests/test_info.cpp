@@ -0,0 +1,138 @@
+/*
+Copyright 2023 Tauno Erik
+
+Product info: decoded and cached strings, one write for missing fields,
+request done after all answers, payload sizes
+*/
+
+#include "radar_test.h"
+
+static void feed_info(Radar_MR24HPC1 *radar, uint8_t cmd, const char *text) {
+  uint8_t frame[FRAME_SIZE];
+  size_t len = test_frame(frame, 0x02, cmd,
+                          reinterpret_cast<const uint8_t *>(text),
+                          strlen(text));
+  radar->feed(frame, len);
+  radar->run();
+}
+
+static void test_cached() {
+  TestStream radar_port;
+  Radar_MemoryStream sim_port;
+  sim_port.connect(&radar_port);
+
+  Radar_SimConfig config;
+  config.presence_report_ms = 0;
+  config.sensor_report_ms = 0;
+  Radar_Simulator sim(&sim_port);
+  sim.set_config(config);
+
+  Radar_MR24HPC1 radar(&radar_port);
+  unsigned long now = 0;
+  CHECK(!radar.has_device_info());
+
+  Radar_Request req = radar.ask_device_info();
+  CHECK(req.id != 0);
+  CHECK_EQ(radar_port.writes, 1);
+
+  test_run(&sim, &radar, now, 50);
+  CHECK_EQ(sim.get_stats().queries, 4);
+  CHECK_EQ(radar.get_request_status(req), REQUEST_DONE);
+  CHECK(radar.has_device_info());
+
+  const Radar_DeviceInfo &info = radar.get_device_info();
+  CHECK(strcmp(info.product_model, "MR24HPC1") == 0);
+  CHECK(strcmp(info.product_id, "00000001") == 0);
+  CHECK(strcmp(info.hardware_model, "G60SM1SYv010003") == 0);
+  CHECK(strcmp(info.firmware_version, "G60SM1SYv010106") == 0);
+  CHECK_EQ(info.received, INFO_ALL);
+
+  // Cached, radar is not asked again
+  CHECK_EQ(radar.ask_device_info().id, 0);
+  CHECK_EQ(radar_port.writes, 1);
+  test_run(&sim, &radar, now, 50);
+  CHECK_EQ(sim.get_stats().queries, 4);
+}
+
+/*
+Only missing fields are asked, in one write
+*/
+static void test_missing() {
+  TestStream port;
+  Radar_MemoryStream device;
+  device.connect(&port);
+  Radar_MR24HPC1 radar(&port);
+
+  feed_info(&radar, 0xA1, "MR24HPC1");
+  feed_info(&radar, 0xA3, "G60SM1SYv010003");
+  CHECK_EQ(radar.get_device_info().received,
+           INFO_PRODUCT_MODEL | INFO_HARDWARE_MODEL);
+
+  radar.ask_device_info();
+  CHECK_EQ(port.writes, 1);
+
+  uint8_t sent[2 * QUERY_SIZE + 1];
+  CHECK_EQ(device.read_bytes(sent, sizeof(sent)), 2 * QUERY_SIZE);
+  CHECK_EQ(sent[I_CMD_WORD], 0xA2);
+  CHECK_EQ(sent[QUERY_SIZE + I_CMD_WORD], 0xA4);
+}
+
+/*
+Answers come in order, request is done by the last one
+*/
+static void test_done_after_all() {
+  TestStream port;
+  Radar_MemoryStream device;
+  device.connect(&port);
+  Radar_MR24HPC1 radar(&port);
+
+  Radar_Request req = radar.ask_device_info();
+
+  feed_info(&radar, 0xA1, "MR24HPC1");
+  feed_info(&radar, 0xA2, "00000001");
+  feed_info(&radar, 0xA3, "G60SM1SYv010003");
+  CHECK_EQ(radar.get_request_status(req), REQUEST_PENDING);
+  CHECK(!radar.has_device_info());
+
+  feed_info(&radar, 0xA4, "G60SM1SYv010106");
+  CHECK_EQ(radar.get_request_status(req), REQUEST_DONE);
+  CHECK(radar.has_device_info());
+}
+
+static void test_payload_size() {
+  Radar_MemoryStream port;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+
+  // Empty text
+  feed_info(&radar, 0xA1, "");
+  CHECK_EQ(strlen(radar.get_device_info().product_model), 0);
+  CHECK(radar.get_device_info().received & INFO_PRODUCT_MODEL);
+
+  // Longest frame fills text
+  char text[INFO_TEXT_SIZE];
+  memset(text, 'x', INFO_TEXT_SIZE - 1);
+  text[INFO_TEXT_SIZE - 1] = '\0';
+  feed_info(&radar, 0xA2, text);
+  CHECK_EQ(strlen(radar.get_device_info().product_id), INFO_TEXT_SIZE - 1);
+
+  // Longer than a frame: dropped by parser, field is not received
+  uint8_t data[FRAME_SIZE];
+  memset(data, 'y', sizeof(data));
+  uint8_t frame[2 * FRAME_SIZE];
+  size_t len = test_frame(frame, 0x02, 0xA3, data, sizeof(data));
+  radar.feed(frame, len);
+  radar.run();
+  CHECK(!(radar.get_device_info().received & INFO_HARDWARE_MODEL));
+  CHECK_EQ(counters.get_truncated(), 1);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_cached();
+  test_missing();
+  test_done_after_all();
+  test_payload_size();
+  return test_result("test_info");
+}
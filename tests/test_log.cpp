@@ -0,0 +1,132 @@
+/*
+Copyright 2023 Tauno Erik
+
+Buffered VERBAL log: output room, outputs without
+availableForWrite() and dropped frames of text
+*/
+
+#include <string>
+
+#include "radar_test.h"
+
+/*
+Print with room that writes use up
+Base availableForWrite() tells 0, like SoftwareSerial and File.
+*/
+class TestPrint : public Print {
+ public:
+    std::string text;
+    int room = 0;
+    bool tells_room = false;
+    bool blocked = false;  // Takes nothing
+
+    size_t write(uint8_t byte) override {
+      if (blocked) {
+        return 0;
+      }
+      text += static_cast<char>(byte);
+      if (room > 0) {
+        room--;
+      }
+      return 1;
+    }
+    using Print::write;
+
+    int availableForWrite() override {
+      return tells_room ? room : Print::availableForWrite();
+    }
+};
+
+static void feed_presence(Radar_MR24HPC1 *radar, uint8_t value) {
+  uint8_t frame[FRAME_SIZE];
+  size_t len = test_frame(frame, 0x80, 0x01, &value, 1);
+  radar->feed(frame, len);
+  radar->run(VERBAL);
+}
+
+/*
+Output without availableForWrite() gets text in short writes
+*/
+static void test_direct() {
+  Radar_MemoryStream port;
+  TestPrint out;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_log_output(&out);
+
+  feed_presence(&radar, OCCUPIED);
+  CHECK(out.text.size() > 0);
+  CHECK(out.text.size() <= LOG_DIRECT_WRITE);
+
+  for (int i = 0; i < 10; i++) {
+    radar.run(VERBAL);
+  }
+  CHECK(out.text == "Occupied!\r\n");
+  CHECK_EQ(radar.get_log_dropped(), 0);
+}
+
+static void test_room() {
+  Radar_MemoryStream port;
+  TestPrint out;
+  out.tells_room = true;
+  out.room = 4;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_log_output(&out);
+
+  feed_presence(&radar, UNOCCUPIED);
+  CHECK_EQ(out.text.size(), 4);
+
+  out.room = 4;
+  radar.run(VERBAL);
+  CHECK_EQ(out.text.size(), 8);
+
+  // Full output is not written
+  radar.run(VERBAL);
+  CHECK_EQ(out.text.size(), 8);
+
+  out.room = 100;
+  radar.run(VERBAL);
+  CHECK(out.text == "Unoccupied!\r\n");
+}
+
+/*
+Text that does not fit is dropped whole
+*/
+static void test_dropped() {
+  Radar_MemoryStream port;
+  TestPrint out;
+  out.tells_room = true;
+  out.blocked = true;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_log_output(&out);
+
+  int frames = LOG_BUFFER_SIZE / 10 + 2;
+  for (int i = 0; i < frames; i++) {
+    feed_presence(&radar, OCCUPIED);
+  }
+  CHECK(radar.get_log_dropped() > 0);
+
+  out.blocked = false;
+  out.room = 1000;
+  radar.run(VERBAL);
+  size_t line = strlen("Occupied!\r\n");
+  CHECK_EQ(out.text.size() % line, 0);
+  CHECK_EQ(out.text.size() / line + radar.get_log_dropped(), frames);
+}
+
+static void test_no_output() {
+  Radar_MemoryStream port;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_log_output(nullptr);
+
+  feed_presence(&radar, OCCUPIED);
+  CHECK_EQ(radar.get_log_dropped(), 1);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_direct();
+  test_room();
+  test_dropped();
+  test_no_output();
+  return test_result("test_log");
+}
@@ -0,0 +1,173 @@
+/*
+Copyright 2023 Tauno Erik
+
+Radar_Manager: radars on pseudo-terminals with simulators,
+run() on readable ports, spread and batched polls, deadlines, remove
+*/
+
+#include "host/Radar_manager.h"
+#include "radar_test.h"
+
+#define RADARS 2
+
+/*
+Master side of pty that counts writes and reads of radar
+*/
+class CountingPort : public Radar_PosixStream {
+ public:
+    int writes = 0;
+    int checks = 0;  // available() calls, radar run() reads
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+      writes++;
+      return Radar_PosixStream::write(buffer, size);
+    }
+    using Radar_PosixStream::write;
+
+    int available() override {
+      checks++;
+      return Radar_PosixStream::available();
+    }
+};
+
+struct Rig {
+  Radar_Manager manager;
+  CountingPort *ports[RADARS];
+  Radar_PosixStream devices[RADARS];
+  Radar_Simulator *sims[RADARS];
+
+  Rig() {
+    Radar_SimConfig config;
+    config.presence_report_ms = 0;
+    config.sensor_report_ms = 0;
+
+    for (int i = 0; i < RADARS; i++) {
+      char slave[64];
+      ports[i] = new CountingPort();
+      CHECK(ports[i]->open_pty(slave, sizeof(slave)));
+      CHECK(devices[i].open(slave));
+      CHECK_EQ(manager.add(ports[i]), i);
+
+      sims[i] = new Radar_Simulator(&devices[i]);
+      sims[i]->set_config(config);
+    }
+  }
+
+  ~Rig() {
+    for (int i = 0; i < RADARS; i++) {
+      delete sims[i];
+    }
+  }
+
+  // Simulators answer, manager runs until ms have passed
+  void run(unsigned long ms) {
+    unsigned long start = millis();
+    while (millis() - start < ms) {
+      for (int i = 0; i < RADARS; i++) {
+        sims[i]->run(millis());
+      }
+      manager.run(5);
+    }
+  }
+};
+
+static void test_readable() {
+  Rig rig;
+  Radar_Counters counters[RADARS];
+  for (int i = 0; i < RADARS; i++) {
+    rig.manager.get(i)->set_counters(&counters[i]);
+  }
+
+  CHECK_EQ(rig.manager.run(20), 0);
+  CHECK_EQ(rig.ports[0]->checks, 0);
+  CHECK_EQ(rig.ports[1]->checks, 0);
+
+  uint8_t activity = 50;
+  rig.sims[0]->send_frame(0x80, 0x03, &activity, 1);
+
+  int ready = 0;
+  unsigned long start = millis();
+  while (ready == 0 && millis() - start < 1000) {
+    ready = rig.manager.run(100);
+  }
+  CHECK_EQ(ready, 1);
+  CHECK_EQ(counters[0].get_frames(), 1);
+  CHECK(rig.ports[0]->checks > 0);
+  CHECK_EQ(rig.ports[1]->checks, 0);  // No data, not run
+}
+
+/*
+Radar 1 polls half an interval after radar 0,
+queries due at once go out with one write
+*/
+static void test_polls() {
+  Rig rig;
+  rig.manager.poll_every(&Radar_MR24HPC1::ask_presence, 400);
+  rig.manager.poll_every(&Radar_MR24HPC1::ask_heartbeat, 400);
+
+  rig.run(100);
+  CHECK_EQ(rig.ports[0]->writes, 1);
+  CHECK_EQ(rig.ports[1]->writes, 0);
+  CHECK_EQ(rig.sims[0]->get_stats().queries, 2);
+
+  rig.run(200);
+  CHECK_EQ(rig.ports[0]->writes, 1);
+  CHECK_EQ(rig.ports[1]->writes, 1);
+  CHECK_EQ(rig.sims[1]->get_stats().queries, 2);
+  CHECK_EQ(rig.manager.get_queries_sent(), 4);
+}
+
+/*
+Silent radar: request deadline wakes the loop and times out
+*/
+static void test_deadline() {
+  Rig rig;
+  Radar_MR24HPC1 *radar = rig.manager.get(0);
+  radar->set_request_timeout(50);
+  Radar_Request req = radar->ask_heartbeat();
+  CHECK(radar->time_to_deadline() > 0);
+
+  unsigned long start = millis();
+  CHECK_EQ(rig.manager.run(-1), 0);
+  CHECK(millis() - start < 1000);
+
+  // Timed out by manager, not by asking
+  CHECK_EQ(radar->time_to_deadline(), -1);
+  CHECK_EQ(radar->get_request_status(req), REQUEST_TIMEOUT);
+}
+
+static void test_remove() {
+  Rig rig;
+  rig.manager.poll_every(&Radar_MR24HPC1::ask_heartbeat, 100);
+
+  rig.manager.remove(1);
+  CHECK(rig.manager.get(1) == nullptr);
+  CHECK(rig.manager.get_port(1) == nullptr);
+  CHECK(!rig.manager.is_open(1));
+  CHECK_EQ(rig.manager.count(), RADARS);
+  rig.manager.remove(1);  // Again does nothing
+
+  rig.run(250);
+  CHECK(rig.sims[0]->get_stats().queries > 0);
+  CHECK_EQ(rig.sims[1]->get_stats().queries, 0);
+}
+
+/*
+Failed add leaves port to caller
+*/
+static void test_add_error() {
+  Radar_Manager manager;
+  Radar_PosixStream closed;
+  CHECK_EQ(manager.add(&closed), -1);
+  CHECK_EQ(manager.count(), 0);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_readable();
+  test_polls();
+  test_deadline();
+  test_remove();
+  test_add_error();
+  return test_result("test_manager");
+}
@@ -0,0 +1,213 @@
+/*
+Copyright 2023 Tauno Erik
+
+Frame parser: split input, header bytes in data and resync
+*/
+
+#include "radar_test.h"
+
+#define MAX_VALUES 16
+
+static int values[MAX_VALUES];
+static int values_count = 0;
+
+static void on_value(Radar_MR24HPC1 *, int value) {
+  if (values_count < MAX_VALUES) {
+    values[values_count++] = value;
+  }
+}
+
+static size_t activity_frame(uint8_t *out, uint8_t value) {
+  return test_frame(out, 0x80, 0x03, &value, 1);
+}
+
+static void test_split() {
+  Radar_MemoryStream port;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+  radar.on_activity(on_value);
+  values_count = 0;
+
+  uint8_t frame[FRAME_SIZE];
+  size_t len = activity_frame(frame, 42);
+
+  // One byte at a time
+  for (size_t i = 0; i < len; i++) {
+    CHECK_EQ(radar.feed(&frame[i], 1), 1);
+    radar.run();
+  }
+  CHECK_EQ(values_count, 1);
+  CHECK_EQ(values[0], 42);
+  CHECK_EQ(radar.get_resyncs(), 0);
+}
+
+static void test_header_in_data() {
+  Radar_MemoryStream port;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+  radar.on_activity(on_value);
+  values_count = 0;
+
+  // Data bytes look like header and tail
+  uint8_t frame[FRAME_SIZE];
+  size_t len = activity_frame(frame, HEAD1);
+  radar.feed(frame, len);
+  len = activity_frame(frame, END2);
+  radar.feed(frame, len);
+  radar.run();
+
+  CHECK_EQ(values_count, 2);
+  CHECK_EQ(values[0], HEAD1);
+  CHECK_EQ(values[1], END2);
+  CHECK_EQ(radar.get_resyncs(), 0);
+}
+
+static void test_garbage() {
+  Radar_MemoryStream port;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+  radar.on_activity(on_value);
+  values_count = 0;
+
+  uint8_t buffer[64];
+  size_t n = 0;
+  buffer[n++] = 0x00;
+  buffer[n++] = HEAD1;  // False start
+  buffer[n++] = 0x11;
+  buffer[n++] = 0x22;
+  n += activity_frame(&buffer[n], 7);
+
+  CHECK_EQ(radar.feed(buffer, n), n);
+  radar.run();
+
+  CHECK_EQ(values_count, 1);
+  CHECK_EQ(values[0], 7);
+  CHECK_EQ(radar.get_resyncs(), 1);
+  CHECK_EQ(radar.get_discarded_bytes(), 4);
+  CHECK_EQ(radar.get_last_discarded(), 4);
+}
+
+static void test_bad_checksum() {
+  Radar_MemoryStream port;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+  radar.on_activity(on_value);
+  values_count = 0;
+
+  uint8_t buffer[64];
+  size_t n = activity_frame(buffer, 1);
+  buffer[n - 3]++;  // Checksum
+  size_t bad = n;
+  n += activity_frame(&buffer[n], 2);
+
+  radar.feed(buffer, n);
+  radar.run();
+
+  CHECK_EQ(values_count, 1);
+  CHECK_EQ(values[0], 2);
+  CHECK_EQ(radar.get_resyncs(), 1);
+  CHECK_EQ(radar.get_discarded_bytes(), bad);
+}
+
+/*
+Bytes lost inside a frame: next frame starts before the
+broken one is complete and is found again by resync
+*/
+static void test_lost_bytes() {
+  Radar_MemoryStream port;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+  radar.on_activity(on_value);
+  values_count = 0;
+
+  uint8_t buffer[64];
+  size_t n = activity_frame(buffer, 1);
+  n -= 4;  // Lose data, checksum and tail
+  size_t lost = n;
+  n += activity_frame(&buffer[n], 2);
+  n += activity_frame(&buffer[n], 3);
+
+  radar.feed(buffer, n);
+  radar.run();
+
+  CHECK_EQ(values_count, 2);
+  CHECK_EQ(values[0], 2);
+  CHECK_EQ(values[1], 3);
+  CHECK_EQ(radar.get_resyncs(), 1);
+  CHECK_EQ(radar.get_discarded_bytes(), lost);
+}
+
+static void test_impossible_length() {
+  Radar_MemoryStream port;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+  radar.on_activity(on_value);
+  values_count = 0;
+
+  uint8_t buffer[64];
+  size_t n = 0;
+  buffer[n++] = HEAD1;
+  buffer[n++] = HEAD2;
+  buffer[n++] = 0x80;
+  buffer[n++] = 0x03;
+  buffer[n++] = 0xFF;  // Length
+  buffer[n++] = 0xFF;
+  n += activity_frame(&buffer[n], 9);
+
+  radar.feed(buffer, n);
+  radar.run();
+
+  CHECK_EQ(values_count, 1);
+  CHECK_EQ(values[0], 9);
+  CHECK_EQ(radar.get_discarded_bytes(), 6);
+}
+
+/*
+Full queue stops feed(), rest is given again later
+*/
+static void test_queue_full() {
+  Radar_MemoryStream port;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+  radar.on_activity(on_value);
+  values_count = 0;
+
+  uint8_t buffer[FRAME_QUEUE_SIZE * 2 * 16];
+  size_t n = 0;
+  for (int i = 0; i < FRAME_QUEUE_SIZE * 2; i++) {
+    n += activity_frame(&buffer[n], i);
+  }
+
+  size_t used = radar.feed(buffer, n);
+  CHECK(used < n);
+  while (used < n) {
+    radar.run();
+    used += radar.feed(&buffer[used], n - used);
+  }
+  radar.run();
+
+  CHECK_EQ(values_count, FRAME_QUEUE_SIZE * 2);
+  for (int i = 0; i < values_count; i++) {
+    CHECK_EQ(values[i], i);
+  }
+  CHECK_EQ(radar.get_resyncs(), 0);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_split();
+  test_header_in_data();
+  test_garbage();
+  test_bad_checksum();
+  test_lost_bytes();
+  test_impossible_length();
+  test_queue_full();
+  return test_result("test_parser");
+}
@@ -0,0 +1,98 @@
+/*
+Copyright 2023 Tauno Erik
+
+Request handles: response, shared slot, timeout and slot reuse
+*/
+
+#include <unistd.h>
+
+#include "radar_test.h"
+
+static void test_response() {
+  Radar_MemoryStream sim_port;
+  Radar_MemoryStream radar_port;
+  sim_port.connect(&radar_port);
+
+  Radar_SimConfig config;
+  config.presence_report_ms = 0;
+  config.sensor_report_ms = 0;
+  Radar_Simulator sim(&sim_port);
+  sim.set_config(config);
+
+  Radar_MR24HPC1 radar(&radar_port);
+  unsigned long now = 0;
+
+  Radar_Request heartbeat = radar.ask_heartbeat();
+  Radar_Request presence = radar.ask_presence();
+  CHECK(heartbeat.id != 0);
+  CHECK(presence.id != heartbeat.id);
+  CHECK_EQ(radar.get_request_status(heartbeat), REQUEST_PENDING);
+
+  test_run(&sim, &radar, now, 50);
+  CHECK_EQ(radar.get_request_status(heartbeat), REQUEST_DONE);
+  CHECK_EQ(radar.get_request_status(presence), REQUEST_DONE);
+
+  // Done request is still known until its slot is used again
+  CHECK_EQ(radar.get_request_status(heartbeat), REQUEST_DONE);
+}
+
+static void test_slots() {
+  Radar_MemoryStream port;  // No radar, nothing is answered
+  Radar_MR24HPC1 radar(&port);
+
+  // Same query waiting shares its slot
+  Radar_Request first = radar.ask_heartbeat();
+  Radar_Request again = radar.ask_heartbeat();
+  CHECK_EQ(again.slot, first.slot);
+  CHECK_EQ(again.id, first.id);
+
+  Radar_Request requests[REQUEST_SLOTS];
+  requests[0] = first;
+  requests[1] = radar.ask_presence();
+  requests[2] = radar.ask_motion();
+  requests[3] = radar.ask_activity();
+  for (int i = 0; i < REQUEST_SLOTS; i++) {
+    CHECK_EQ(radar.get_request_status(requests[i]), REQUEST_PENDING);
+  }
+
+  // All slots pending
+  Radar_Request full = radar.ask_direction();
+  CHECK_EQ(full.id, 0);
+  CHECK_EQ(radar.get_request_status(full), REQUEST_ERROR);
+}
+
+static void test_timeout() {
+  Radar_MemoryStream port;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_request_timeout(20);
+
+  Radar_Request req = radar.ask_heartbeat();
+  CHECK_EQ(radar.get_request_status(req), REQUEST_PENDING);
+  CHECK(!radar.wait(req));
+  CHECK_EQ(radar.get_request_status(req), REQUEST_TIMEOUT);
+
+  // Timed out slots are used again, old handle is not valid
+  radar.set_request_timeout(200);  // All four are asked in time
+  Radar_Request next[REQUEST_SLOTS];
+  next[0] = radar.ask_presence();
+  next[1] = radar.ask_motion();
+  next[2] = radar.ask_activity();
+  next[3] = radar.ask_direction();
+  for (int i = 0; i < REQUEST_SLOTS; i++) {
+    CHECK(next[i].id != 0);
+  }
+  CHECK_EQ(radar.get_request_status(req), REQUEST_ERROR);
+
+  usleep(250000);
+  for (int i = 0; i < REQUEST_SLOTS; i++) {
+    CHECK_EQ(radar.get_request_status(next[i]), REQUEST_TIMEOUT);
+  }
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_response();
+  test_slots();
+  test_timeout();
+  return test_result("test_requests");
+}
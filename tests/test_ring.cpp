@@ -0,0 +1,131 @@
+/*
+Copyright 2023 Tauno Erik
+
+SPSC receive ring: full ring, wrap around and thread producer
+*/
+
+#include <thread>
+
+#include "radar_test.h"
+
+#define THREAD_BYTES 1000000
+
+static void test_full() {
+  Radar_RxRing ring;
+
+  for (int i = 0; i < RX_RING_SIZE; i++) {
+    CHECK(ring.push(static_cast<uint8_t>(i)));
+  }
+  CHECK(!ring.push(0xFF));
+  CHECK_EQ(ring.available(), RX_RING_SIZE);
+  CHECK_EQ(ring.get_dropped(), 1);
+
+  const uint8_t *data;
+  CHECK_EQ(ring.peek(&data), RX_RING_SIZE);
+  CHECK_EQ(data[0], 0);
+  CHECK_EQ(data[RX_RING_SIZE - 1], RX_RING_SIZE - 1);
+
+  ring.consume(RX_RING_SIZE);
+  CHECK_EQ(ring.available(), 0);
+  CHECK_EQ(ring.peek(&data), 0);
+}
+
+/*
+peek() gives bytes until the end of buffer, the rest after consume()
+*/
+static void test_wrap() {
+  Radar_RxRing ring;
+  uint8_t bytes[RX_RING_SIZE];
+  for (int i = 0; i < RX_RING_SIZE; i++) {
+    bytes[i] = static_cast<uint8_t>(i);
+  }
+
+  CHECK_EQ(ring.push(bytes, RX_RING_SIZE - 4), RX_RING_SIZE - 4);
+  ring.consume(RX_RING_SIZE - 4);
+
+  CHECK_EQ(ring.push(bytes, 10), 10);
+  CHECK_EQ(ring.available(), 10);
+
+  const uint8_t *data;
+  CHECK_EQ(ring.peek(&data), 4);
+  CHECK_EQ(data[0], 0);
+  ring.consume(4);
+
+  CHECK_EQ(ring.peek(&data), 6);
+  CHECK_EQ(data[0], 4);
+  CHECK_EQ(data[5], 9);
+  ring.consume(6);
+  CHECK_EQ(ring.available(), 0);
+}
+
+/*
+Producer thread and consumer see all bytes in order
+*/
+static void test_threads() {
+  static Radar_RxRing ring;
+
+  std::thread producer([] {
+    for (uint32_t i = 0; i < THREAD_BYTES; ) {
+      if (ring.push(static_cast<uint8_t>(i))) {
+        i++;
+      } else {
+        std::this_thread::yield();  // Ring is full
+      }
+    }
+  });
+
+  uint32_t received = 0;
+  uint32_t errors = 0;
+  while (received < THREAD_BYTES) {
+    const uint8_t *data;
+    size_t len = ring.peek(&data);
+    if (len == 0) {
+      std::this_thread::yield();
+    }
+    for (size_t i = 0; i < len; i++) {
+      if (data[i] != static_cast<uint8_t>(received + i)) {
+        errors++;
+      }
+    }
+    ring.consume(len);
+    received += len;
+  }
+  producer.join();
+
+  CHECK_EQ(received, THREAD_BYTES);
+  CHECK_EQ(errors, 0);
+}
+
+/*
+Radar parses frames from ring, also across its end
+*/
+static void test_radar() {
+  Radar_MemoryStream port;
+  Radar_RxRing ring;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+  radar.set_rx_ring(&ring);
+
+  uint8_t frame[FRAME_SIZE];
+  int presence = UNOCCUPIED;
+  for (int i = 0; i < 20; i++) {
+    presence = i % 2 == 0 ? OCCUPIED : UNOCCUPIED;
+    uint8_t value = static_cast<uint8_t>(presence);
+    size_t len = test_frame(frame, 0x80, 0x01, &value, 1);
+    CHECK_EQ(ring.push(frame, len), len);
+    radar.run();
+    CHECK_EQ(radar.get_presence(), presence);
+  }
+  CHECK_EQ(ring.available(), 0);
+  CHECK_EQ(radar.get_resyncs(), 0);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_full();
+  test_wrap();
+  test_threads();
+  test_radar();
+  return test_result("test_ring");
+}
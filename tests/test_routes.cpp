@@ -0,0 +1,115 @@
+/*
+Copyright 2023 Tauno Erik
+
+Routes table: every control and command word pair handled before the
+table still reaches a handler, unknown pairs are only counted
+*/
+
+#include "radar_test.h"
+
+struct RouteCase {
+  uint8_t control_word;
+  uint8_t cmd_word;
+  uint8_t len;  // Data bytes
+};
+
+static const RouteCase routes[] = {
+  // Heartbeat, reset
+  {0x01, 0x01, 0}, {0x01, 0x02, 1},
+  // Product info
+  {0x02, 0xA1, 8}, {0x02, 0xA2, 8}, {0x02, 0xA3, 8}, {0x02, 0xA4, 8},
+  // UART upgrade
+  {0x03, 0x01, 1}, {0x03, 0x02, 1}, {0x03, 0x03, 1},
+  // Work status
+  {0x05, 0x01, 1}, {0x05, 0x07, 1}, {0x05, 0x08, 1}, {0x05, 0x09, 1},
+  {0x05, 0x0A, 1}, {0x05, 0x81, 1}, {0x05, 0x85, 1}, {0x05, 0x87, 1},
+  {0x05, 0x88, 1}, {0x05, 0x89, 1},
+  // Underlying open function
+  {0x08, 0x00, 1}, {0x08, 0x01, 5}, {0x08, 0x08, 1}, {0x08, 0x09, 1},
+  {0x08, 0x0A, 1}, {0x08, 0x0B, 1}, {0x08, 0x0C, 4}, {0x08, 0x0D, 4},
+  {0x08, 0x0E, 4}, {0x08, 0x80, 1}, {0x08, 0x81, 1}, {0x08, 0x82, 1},
+  {0x08, 0x83, 1}, {0x08, 0x84, 1}, {0x08, 0x88, 1}, {0x08, 0x89, 1},
+  {0x08, 0x8A, 1}, {0x08, 0x8B, 1}, {0x08, 0x8C, 4}, {0x08, 0x8D, 4},
+  {0x08, 0x8E, 4},
+  // Human presence
+  {0x80, 0x01, 1}, {0x80, 0x02, 1}, {0x80, 0x03, 1}, {0x80, 0x0A, 1},
+  {0x80, 0x0B, 1}, {0x80, 0x81, 1}, {0x80, 0x82, 1}, {0x80, 0x83, 1},
+  {0x80, 0x8A, 1}, {0x80, 0x8B, 1},
+};
+
+static const uint8_t unknown[][2] = {
+  {0x01, 0x03}, {0x02, 0xA5}, {0x04, 0x01}, {0x05, 0x02},
+  {0x08, 0x02}, {0x80, 0x04}, {0xFF, 0xFF},
+};
+
+#define ROUTES (sizeof(routes) / sizeof(routes[0]))
+#define UNKNOWN (sizeof(unknown) / sizeof(unknown[0]))
+
+static void feed(Radar_MR24HPC1 *radar, uint8_t cw, uint8_t cmd,
+                 uint8_t len) {
+  uint8_t data[8] = {0x01, 0x02, 0x03, 0x04, 0x0A, 0x00, 0x00, 0x00};
+  uint8_t frame[FRAME_SIZE];
+  size_t n = test_frame(frame, cw, cmd, data, len);
+  radar->feed(frame, n);
+  radar->run();
+}
+
+static void test_routes() {
+  Radar_MemoryStream port;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+
+  for (size_t i = 0; i < ROUTES; i++) {
+    const RouteCase &r = routes[i];
+    feed(&radar, r.control_word, r.cmd_word, r.len);
+
+    if (counters.get_command_frames(r.control_word, r.cmd_word) != 1) {
+      printf("route 0x%02X 0x%02X not handled\n",
+             r.control_word, r.cmd_word);
+      CHECK(false);
+    }
+  }
+  CHECK_EQ(counters.get_frames(), ROUTES);
+  CHECK_EQ(counters.get_unknown(), 0);
+
+  // One histogram slot per route
+  int slots = 0;
+  for (uint8_t i = 0; i < COUNTER_COMMANDS; i++) {
+    uint8_t cw, cmd;
+    if (counters.get_command(i, cw, cmd) > 0) {
+      slots++;
+    }
+  }
+  CHECK_EQ(slots, ROUTES);
+}
+
+static void test_unknown() {
+  Radar_MemoryStream port;
+  Radar_Counters counters;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_counters(&counters);
+
+  for (size_t i = 0; i < UNKNOWN; i++) {
+    feed(&radar, unknown[i][0], unknown[i][1], 1);
+    CHECK_EQ(radar.get_unknown_frames(), i + 1);
+
+    uint8_t cw, cmd;
+    counters.get_last_unknown(cw, cmd);
+    CHECK_EQ(cw, unknown[i][0]);
+    CHECK_EQ(cmd, unknown[i][1]);
+  }
+
+  CHECK_EQ(counters.get_frames(), UNKNOWN);
+  for (uint8_t i = 0; i < COUNTER_COMMANDS; i++) {
+    uint8_t cw, cmd;
+    CHECK_EQ(counters.get_command(i, cw, cmd), 0);
+  }
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_routes();
+  test_unknown();
+  return test_result("test_routes");
+}
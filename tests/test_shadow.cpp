@@ -0,0 +1,163 @@
+/*
+Copyright 2023 Tauno Erik
+
+Settings shadow: confirmed values are skipped, per custom mode
+*/
+
+#include "radar_test.h"
+
+struct Bench {
+  Radar_MemoryStream sim_port;
+  Radar_MemoryStream radar_port;
+  Radar_Simulator sim;
+  Radar_MR24HPC1 radar;
+  unsigned long now = 0;
+
+  Bench() : sim(&sim_port), radar(&radar_port) {
+    sim_port.connect(&radar_port);
+    Radar_SimConfig config;
+    config.presence_report_ms = 0;
+    config.sensor_report_ms = 0;
+    sim.set_config(config);
+  }
+
+  // Queries simulator got while running
+  uint32_t run(unsigned long ms = 50) {
+    uint32_t queries = sim.get_stats().queries;
+    test_run(&sim, &radar, now, ms);
+    return sim.get_stats().queries - queries;
+  }
+};
+
+static void test_skip() {
+  Bench b;
+  b.radar.set_motion_limit(RANGE_300_CM);
+  CHECK_EQ(b.run(), 3);
+
+  b.radar.set_motion_limit(RANGE_300_CM);
+  CHECK_EQ(b.run(), 0);
+
+  b.radar.set_motion_limit(RANGE_250_CM);
+  CHECK_EQ(b.run(), 3);
+
+  // Forgotten values are sent again
+  b.radar.forget_config();
+  b.radar.set_motion_limit(RANGE_250_CM);
+  CHECK_EQ(b.run(), 3);
+  CHECK_EQ(b.radar.get_config_divergences(), 0);
+}
+
+/*
+Radar reporting other value than set is a divergence
+*/
+static void test_divergence() {
+  Bench b;
+  b.radar.set_motion_limit(RANGE_300_CM);
+  b.run();
+
+  uint8_t other = RANGE_400_CM;
+  b.sim.send_frame(0x08, 0x8B, &other, 1);
+  b.run();
+  CHECK_EQ(b.radar.get_config_divergences(), 1);
+
+  // Value is not trusted anymore
+  b.radar.set_motion_limit(RANGE_300_CM);
+  CHECK_EQ(b.run(), 3);
+}
+
+/*
+Value confirmed in one custom mode is not known in another
+*/
+static void test_custom_mode() {
+  Bench b;
+  {
+    Radar_Transaction tx(&b.radar, 1);
+    tx.set_motion_limit(RANGE_300_CM);
+  }
+  CHECK_EQ(b.run(), 3);
+
+  {
+    Radar_Transaction tx(&b.radar, 2);
+    tx.set_motion_limit(RANGE_300_CM);
+  }
+  CHECK_EQ(b.run(), 3);
+
+  {
+    Radar_Transaction tx(&b.radar, 2);
+    tx.set_motion_limit(RANGE_300_CM);
+  }
+  CHECK_EQ(b.run(), 0);
+
+  // Back to mode 1 forgets mode 2 values
+  b.radar.set_motion_limit(RANGE_300_CM);
+  CHECK_EQ(b.run(), 3);
+  CHECK_EQ(b.radar.get_config_divergences(), 0);
+}
+
+/*
+Host restart: values told by inquiries are not set again
+*/
+static void test_inquired() {
+  Bench b;
+  b.radar.set_motion_limit(RANGE_300_CM);  // Radar has custom mode 1
+  b.run();
+
+  Radar_MR24HPC1 radar(&b.radar_port);
+  radar.ask_motion_limit();
+  radar.ask_custom_mode();  // Order does not matter
+  test_run(&b.sim, &radar, b.now, 50);
+
+  radar.set_motion_limit(RANGE_300_CM);
+  CHECK_EQ(b.sim_port.available(), 0);
+
+  // Value is of custom mode 1 only
+  {
+    Radar_Transaction tx(&radar, 2);
+    tx.set_motion_limit(RANGE_300_CM);
+  }
+  CHECK(b.sim_port.available() > 0);
+}
+
+/*
+Values told before radar changed custom mode are not known
+*/
+static void test_inquired_then_changed() {
+  Bench b;
+  b.radar.ask_motion_limit();
+  b.run();
+  {
+    Radar_Transaction tx(&b.radar, 1);
+    tx.set_static_limit(RANGE_250_CM);
+  }
+  b.run();
+
+  b.radar.set_motion_limit(RANGE_400_CM);
+  CHECK(b.sim_port.available() > 0);
+}
+
+/*
+SIMPLE settings and inquiries are their own entries
+*/
+static void test_simple() {
+  Bench b;
+  b.radar.set_mode(SIMPLE);
+  b.radar.set_motion_limit(0x02);
+  b.run();
+  b.radar.ask_motion_limit();
+  b.run();
+  CHECK_EQ(b.radar.get_config_divergences(), 0);
+
+  b.radar.set_motion_limit(0x02);
+  CHECK_EQ(b.run(), 0);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_skip();
+  test_divergence();
+  test_custom_mode();
+  test_inquired();
+  test_inquired_then_changed();
+  test_simple();
+  return test_result("test_shadow");
+}
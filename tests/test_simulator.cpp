@@ -0,0 +1,69 @@
+/*
+Copyright 2023 Tauno Erik
+
+Simulator settings: SIMPLE and ADVANCED limits are separate
+*/
+
+#include "radar_test.h"
+
+static uint32_t setting_of(Radar_MR24HPC1 *radar, uint8_t control_word,
+                           uint8_t cmd_word) {
+  uint32_t value = 0;
+  CHECK(radar->get_setting(control_word, cmd_word, value));
+  return value;
+}
+
+static void test_limits() {
+  Radar_MemoryStream sim_port;
+  Radar_MemoryStream radar_port;
+  sim_port.connect(&radar_port);
+
+  Radar_SimConfig config;
+  config.presence_report_ms = 0;
+  Radar_Simulator sim(&sim_port);
+  sim.set_config(config);
+
+  Radar_MR24HPC1 radar(&radar_port);
+  unsigned long now = 0;
+
+  // SIMPLE scene and sensitivity
+  radar.set_mode(SIMPLE);
+  radar.set_motion_limit(0x02);
+  radar.set_static_limit(0x01);
+  test_run(&sim, &radar, now, 100);
+
+  radar.ask_motion_limit();
+  radar.ask_static_limit();
+  test_run(&sim, &radar, now, 100);
+  CHECK_EQ(setting_of(&radar, 0x05, 0x07), 0x02);
+  CHECK_EQ(setting_of(&radar, 0x05, 0x08), 0x01);
+
+  // ADVANCED boundaries do not change SIMPLE settings
+  radar.set_mode(ADVANCED);
+  test_run(&sim, &radar, now, 100);
+  radar.set_motion_limit(RANGE_250_CM);
+  radar.set_static_limit(RANGE_150_CM);
+  test_run(&sim, &radar, now, 100);
+
+  radar.ask_motion_limit();
+  radar.ask_static_limit();
+  test_run(&sim, &radar, now, 100);
+  CHECK_EQ(setting_of(&radar, 0x08, 0x0B), RANGE_250_CM);
+  CHECK_EQ(setting_of(&radar, 0x08, 0x0A), RANGE_150_CM);
+
+  radar.set_mode(SIMPLE);
+  test_run(&sim, &radar, now, 100);
+  radar.ask_motion_limit();
+  radar.ask_static_limit();
+  test_run(&sim, &radar, now, 100);
+  CHECK_EQ(setting_of(&radar, 0x05, 0x07), 0x02);
+  CHECK_EQ(setting_of(&radar, 0x05, 0x08), 0x01);
+
+  CHECK_EQ(radar.get_config_divergences(), 0);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_limits();
+  return test_result("test_simulator");
+}
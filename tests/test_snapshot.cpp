@@ -0,0 +1,148 @@
+/*
+Copyright 2023 Tauno Erik
+
+Seqlock snapshot: reader threads never see a half written state
+*/
+
+#include <atomic>
+#include <thread>
+
+#include "radar_test.h"
+
+#define PUBLISHES 200000
+#define MIN_READS 1000
+
+static void fill(Radar_State &s, int value) {
+  s.mode = value;
+  s.heartbeat = value;
+  s.presence = value;
+  s.motion = value;
+  s.activity = value;
+  s.direction = value;
+  s.static_energy = value;
+  s.static_distance = value;
+  s.motion_energy = value;
+  s.motion_distance = value;
+  s.motion_speed = value;
+  s.motion_trigger_limit = value;
+  s.static_trigger_limit = value;
+  s.motion_energy_threshold = value;
+  s.static_energy_threshold = value;
+  s.motion_trigger_time = value;
+  s.motion_to_static_time = value;
+  s.time_for_entering_no_person_state = value;
+  s.custom_mode = value;
+  s.initialization_status = value;
+  s.updated = value;
+}
+
+static bool is_whole(const Radar_State &s) {
+  int v = s.mode;
+  return s.heartbeat == v && s.presence == v && s.motion == v
+    && s.activity == v && s.direction == v
+    && s.static_energy == v && s.static_distance == v
+    && s.motion_energy == v && s.motion_distance == v
+    && s.motion_speed == v
+    && s.motion_trigger_limit == v && s.static_trigger_limit == v
+    && s.motion_energy_threshold == v && s.static_energy_threshold == v
+    && s.motion_trigger_time == v && s.motion_to_static_time == v
+    && s.time_for_entering_no_person_state == v
+    && s.custom_mode == v && s.initialization_status == v
+    && s.updated == static_cast<unsigned long>(v);
+}
+
+static void test_sequence() {
+  Radar_Snapshot snapshot;
+  Radar_State s;
+  fill(s, 5);
+
+  CHECK_EQ(snapshot.get_sequence(), 0);
+  snapshot.publish(s);
+  CHECK_EQ(snapshot.get_sequence(), 2);
+
+  Radar_State r;
+  CHECK(snapshot.try_read(r));
+  CHECK(is_whole(r));
+  CHECK_EQ(r.mode, 5);
+}
+
+static void test_threads() {
+  static Radar_Snapshot snapshot;
+  std::atomic<uint32_t> reads(0);
+  std::atomic<int> last_published(0);
+
+  // Until reader has seen enough, also when it starts late
+  std::thread writer([&reads, &last_published] {
+    Radar_State s;
+    int i = 1;
+    for (; i <= PUBLISHES || reads < MIN_READS; i++) {
+      fill(s, i);
+      snapshot.publish(s);
+      if (i % 1000 == 0) {
+        std::this_thread::yield();
+      }
+    }
+    last_published = i - 1;
+  });
+
+  uint32_t torn = 0;
+  uint32_t backwards = 0;
+  int last = 0;
+  while (last_published == 0) {
+    Radar_State s;
+    if (!snapshot.try_read(s)) {
+      std::this_thread::yield();  // Writer is busy
+      continue;
+    }
+    if (!is_whole(s)) {
+      torn++;
+    }
+    if (s.mode < last) {
+      backwards++;
+    }
+    last = s.mode;
+    reads++;
+  }
+  writer.join();
+
+  Radar_State s;
+  snapshot.read(s);
+  CHECK_EQ(s.mode, last_published);
+  CHECK(is_whole(s));
+  CHECK_EQ(torn, 0);
+  CHECK_EQ(backwards, 0);
+  CHECK(reads >= MIN_READS);
+}
+
+/*
+Radar publishes after every frame
+*/
+static void test_radar() {
+  Radar_MemoryStream port;
+  Radar_Snapshot snapshot;
+  Radar_MR24HPC1 radar(&port);
+  radar.set_snapshot(&snapshot);
+
+  uint8_t frame[FRAME_SIZE];
+  uint8_t value = OCCUPIED;
+  size_t len = test_frame(frame, 0x80, 0x01, &value, 1);
+  radar.feed(frame, len);
+  value = 55;
+  len = test_frame(frame, 0x80, 0x03, &value, 1);
+  radar.feed(frame, len);
+  radar.run();
+
+  CHECK_EQ(snapshot.get_sequence(), 4);
+  Radar_State s;
+  snapshot.read(s);
+  CHECK_EQ(s.presence, OCCUPIED);
+  CHECK_EQ(s.activity, 55);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_sequence();
+  test_threads();
+  test_radar();
+  return test_result("test_snapshot");
+}
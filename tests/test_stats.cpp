@@ -0,0 +1,105 @@
+/*
+Copyright 2023 Tauno Erik
+
+Running statistics: mean, variance and P-square quantile
+*/
+
+#include "radar_test.h"
+
+#define SAMPLES 10000
+
+static uint32_t random_state = 1;
+
+static uint32_t next_random() {
+  random_state = random_state * 1664525 + 1013904223;
+  return random_state >> 8;
+}
+
+static void test_mean() {
+  Radar_Stat stat;
+  const float values[] = {2, 4, 4, 4, 5, 5, 7, 9};
+  for (float v : values) {
+    stat.add(v);
+  }
+
+  Radar_StatSummary s;
+  stat.get_summary(s);
+  CHECK_EQ(s.count, 8);
+  CHECK_NEAR(s.min, 2, 1e-6);
+  CHECK_NEAR(s.max, 9, 1e-6);
+  CHECK_NEAR(s.mean, 5, 1e-6);
+  CHECK_NEAR(s.variance, 32.0 / 7, 1e-5);
+}
+
+/*
+Up to five samples the quantile comes from the samples themselves
+*/
+static void test_few_samples() {
+  const float values[] = {30, 10, 50, 20, 40};
+
+  for (int count = 1; count <= 5; count++) {
+    Radar_Stat high;
+    Radar_Stat low;
+    Radar_Stat median;
+    high.set_quantile(0.9f);
+    low.set_quantile(0.1f);
+    median.set_quantile(0.5f);
+
+    float sorted[5];
+    for (int i = 0; i < count; i++) {
+      high.add(values[i]);
+      low.add(values[i]);
+      median.add(values[i]);
+
+      int j = i;
+      while (j > 0 && sorted[j - 1] > values[i]) {
+        sorted[j] = sorted[j - 1];
+        j--;
+      }
+      sorted[j] = values[i];
+    }
+
+    CHECK_NEAR(high.get_quantile(), sorted[count - 1], 1e-6);
+    CHECK_NEAR(low.get_quantile(), sorted[0], 1e-6);
+    CHECK_NEAR(median.get_quantile(), sorted[count / 2], 1e-6);
+  }
+}
+
+static void test_quantile(float p) {
+  Radar_Stat stat;
+  stat.set_quantile(p);
+
+  for (int i = 0; i < SAMPLES; i++) {
+    stat.add(next_random() % 1000);  // Uniform 0-999
+  }
+
+  CHECK_EQ(stat.get_count(), SAMPLES);
+  CHECK_NEAR(stat.get_quantile(), p * 1000, 20);
+  CHECK_NEAR(stat.get_mean(), 500, 20);
+}
+
+static void test_reset() {
+  Radar_Stat stat;
+  for (int i = 0; i < 100; i++) {
+    stat.add(1000);
+  }
+  stat.reset();
+
+  const float values[] = {1, 2, 3};
+  for (float v : values) {
+    stat.add(v);
+  }
+  CHECK_EQ(stat.get_count(), 3);
+  CHECK_NEAR(stat.get_mean(), 2, 1e-6);
+  CHECK_NEAR(stat.get_quantile(), 3, 1e-6);  // Default 0.9
+}
+
+int main() {
+  test_mean();
+  test_few_samples();
+  test_quantile(0.5f);
+  test_quantile(0.9f);
+  test_quantile(0.99f);
+  test_reset();
+  return test_result("test_stats");
+}
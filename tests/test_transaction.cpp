@@ -0,0 +1,207 @@
+/*
+Copyright 2023 Tauno Erik
+
+Radar_Transaction: one custom mode session, commit and scope exit
+*/
+
+#include "radar_test.h"
+
+#define MAX_SENT 16
+
+/*
+Control and command words of frames radar wrote, in order
+*/
+struct Sent {
+  uint16_t words[MAX_SENT];
+  int count = 0;
+};
+
+static void read_sent(Radar_MemoryStream *device, Sent &sent) {
+  uint8_t bytes[256];
+  size_t len = device->read_bytes(bytes, sizeof(bytes));
+
+  sent.count = 0;
+  size_t i = 0;
+  while (i + I_DATA <= len && sent.count < MAX_SENT) {
+    sent.words[sent.count++] = (bytes[i + I_CONTROL_WORD] << 8)
+                               | bytes[i + I_CMD_WORD];
+    uint16_t data_len = (bytes[i + I_LENGHT_H] << 8) | bytes[i + I_LENGHT_L];
+    i += data_len + FRAME_OVERHEAD;
+  }
+  CHECK_EQ(i, len);
+}
+
+static void test_commit() {
+  Radar_MemoryStream device;
+  Radar_MemoryStream port;
+  device.connect(&port);
+
+  Radar_MR24HPC1 radar(&port);
+  Sent sent;
+
+  Radar_Transaction tx(&radar, 2);
+  tx.set_motion_limit(RANGE_300_CM);
+  tx.set_static_limit(RANGE_250_CM);
+
+  // Nothing is written before commit
+  CHECK_EQ(device.available(), 0);
+
+  Radar_Request saved = tx.commit();
+  CHECK(saved.id != 0);
+  CHECK_EQ(radar.get_request_status(saved), REQUEST_PENDING);
+
+  read_sent(&device, sent);
+  CHECK_EQ(sent.count, 4);
+  CHECK_EQ(sent.words[0], 0x0509);  // Start custom mode
+  CHECK_EQ(sent.words[1], 0x080B);
+  CHECK_EQ(sent.words[2], 0x080A);
+  CHECK_EQ(sent.words[3], 0x050A);  // End and save
+
+  // Second commit does nothing
+  CHECK_EQ(tx.commit().id, 0);
+  CHECK_EQ(device.available(), 0);
+}
+
+static void test_scope_exit() {
+  Radar_MemoryStream device;
+  Radar_MemoryStream port;
+  device.connect(&port);
+
+  Radar_MR24HPC1 radar(&port);
+  Sent sent;
+
+  {
+    Radar_Transaction tx(&radar);
+    tx.set_motion_threshold(40);
+  }
+
+  read_sent(&device, sent);
+  CHECK_EQ(sent.count, 3);
+  CHECK_EQ(sent.words[0], 0x0509);
+  CHECK_EQ(sent.words[1], 0x0809);
+  CHECK_EQ(sent.words[2], 0x050A);
+}
+
+/*
+Without transaction every setter has its own session
+*/
+static void test_single_settings() {
+  Radar_MemoryStream device;
+  Radar_MemoryStream port;
+  device.connect(&port);
+
+  Radar_MR24HPC1 radar(&port);
+  Sent sent;
+
+  radar.set_motion_limit(RANGE_300_CM);
+  radar.set_static_limit(RANGE_250_CM);
+
+  read_sent(&device, sent);
+  CHECK_EQ(sent.count, 6);
+  CHECK_EQ(sent.words[0], 0x0509);
+  CHECK_EQ(sent.words[2], 0x050A);
+  CHECK_EQ(sent.words[3], 0x0509);
+  CHECK_EQ(sent.words[5], 0x050A);
+}
+
+/*
+Radar confirms the settings, same values again send nothing
+*/
+static void test_confirmed() {
+  Radar_MemoryStream sim_port;
+  Radar_MemoryStream radar_port;
+  sim_port.connect(&radar_port);
+
+  Radar_SimConfig config;
+  config.presence_report_ms = 0;
+  config.sensor_report_ms = 0;
+  Radar_Simulator sim(&sim_port);
+  sim.set_config(config);
+
+  Radar_MR24HPC1 radar(&radar_port);
+  unsigned long now = 0;
+
+  Radar_Request saved;
+  {
+    Radar_Transaction tx(&radar);
+    tx.set_motion_limit(RANGE_300_CM);
+    tx.set_absence_trigger_time(60000);
+    saved = tx.commit();
+  }
+  test_run(&sim, &radar, now, 50);
+  CHECK_EQ(radar.get_request_status(saved), REQUEST_DONE);
+  uint32_t queries = sim.get_stats().queries;
+  CHECK_EQ(queries, 4);
+
+  Radar_Transaction tx(&radar);
+  tx.set_motion_limit(RANGE_300_CM);
+  tx.set_absence_trigger_time(60000);
+  CHECK_EQ(tx.commit().id, 0);
+
+  test_run(&sim, &radar, now, 50);
+  CHECK_EQ(sim.get_stats().queries, queries);
+}
+
+/*
+Transaction inside caller's batch does not end it
+*/
+static void test_in_batch() {
+  TestStream port;
+  Radar_MemoryStream device;
+  device.connect(&port);
+
+  Radar_MR24HPC1 radar(&port);
+  Sent sent;
+
+  radar.begin_batch();
+  radar.ask_heartbeat();
+  {
+    Radar_Transaction tx(&radar, 2);
+    tx.set_motion_threshold(40);
+    tx.commit();
+  }
+  CHECK_EQ(port.writes, 0);
+  radar.ask_presence();
+  radar.end_batch();
+  CHECK_EQ(port.writes, 1);
+
+  read_sent(&device, sent);
+  CHECK_EQ(sent.count, 5);
+  CHECK_EQ(sent.words[0], 0x0101);
+  CHECK_EQ(sent.words[1], 0x0509);
+  CHECK_EQ(sent.words[3], 0x050A);
+  CHECK_EQ(sent.words[4], 0x8081);
+}
+
+/*
+Custom mode 0 is not valid, nothing is sent
+*/
+static void test_invalid_mode() {
+  Radar_MemoryStream device;
+  Radar_MemoryStream port;
+  device.connect(&port);
+
+  Radar_MR24HPC1 radar(&port);
+  {
+    Radar_Transaction tx(&radar, 0);
+    CHECK(!tx.is_open());
+    tx.set_motion_limit(RANGE_300_CM);
+    CHECK_EQ(tx.commit().id, 0);
+  }
+  CHECK_EQ(device.available(), 0);
+
+  // Radar is not left in transaction or batch
+  radar.ask_heartbeat();
+  CHECK_EQ(device.available(), QUERY_SIZE);
+}
+
+int main() {
+  radar_set_log_sink(nullptr);
+  test_commit();
+  test_scope_exit();
+  test_single_settings();
+  test_confirmed();
+  test_in_batch();
+  test_invalid_mode();
+  return test_result("test_transaction");
+}